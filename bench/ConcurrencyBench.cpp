@@ -0,0 +1,34 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "SkeletonBench.h"
+#include <mariadb++/concurrency.hpp>
+
+BENCHMARK_F(SkeletonBench, concurrencySubmit)(::benchmark::State &state) {
+    concurrency::set_account(m_account);
+    concurrency::channel_ref channel = concurrency::create_channel();
+
+    for (auto _ : state) concurrency::execute(channel, "DO 1;");
+
+    // drain the channel untimed, work runs in submission order
+    handle last = concurrency::execute(channel, "DO 1;", true);
+    concurrency::wait_handle(last, 1);
+    concurrency::release_handle(last);
+}
+
+BENCHMARK_F(SkeletonBench, concurrencyRoundTrip)(::benchmark::State &state) {
+    concurrency::set_account(m_account);
+    concurrency::channel_ref channel = concurrency::create_channel();
+
+    for (auto _ : state) {
+        handle h = concurrency::query(channel, "SELECT 1;", true);
+        concurrency::wait_handle(h, 0);
+        ::benchmark::DoNotOptimize(concurrency::get_query_result(h));
+        concurrency::release_handle(h);
+    }
+}
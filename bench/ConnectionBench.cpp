@@ -0,0 +1,56 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "SkeletonBench.h"
+
+BENCHMARK_F(SkeletonBench, connectDisconnect)(::benchmark::State &state) {
+    for (auto _ : state) {
+        connection_ref con = connection::create(m_account);
+        con->connect();
+        con->disconnect();
+    }
+}
+
+BENCHMARK_F(SkeletonBench, pointLookupText)(::benchmark::State &state) {
+    u32 id = 0;
+
+    for (auto _ : state) {
+        result_set_ref rs =
+            m_con->query("SELECT s FROM bench_rows WHERE id = " + std::to_string(id++ % bench_row_count + 1) + ";");
+        rs->next();
+        ::benchmark::DoNotOptimize(rs->get_string(0));
+    }
+}
+
+BENCHMARK_F(SkeletonBench, pointLookupPrepared)(::benchmark::State &state) {
+    statement_ref stmt = m_con->create_statement("SELECT s FROM bench_rows WHERE id = ?;");
+    u32 id = 0;
+
+    for (auto _ : state) {
+        stmt->set_unsigned32(0, id++ % bench_row_count + 1);
+        result_set_ref rs = stmt->query();
+        rs->next();
+        ::benchmark::DoNotOptimize(rs->get_string(0));
+    }
+}
+
+BENCHMARK_F(SkeletonBench, insertPrepared)(::benchmark::State &state) {
+    m_con->execute("CREATE TEMPORARY TABLE bench_insert (i INT, d DOUBLE, s VARCHAR(64));");
+    statement_ref stmt = m_con->create_statement("INSERT INTO bench_insert (i, d, s) VALUES (?, ?, ?);");
+    s32 i = 0;
+
+    for (auto _ : state) {
+        stmt->set_signed32(0, i);
+        stmt->set_double(1, i * 0.5);
+        stmt->set_string(2, "inserted row");
+        ::benchmark::DoNotOptimize(stmt->insert());
+        i++;
+    }
+
+    m_con->execute("DROP TEMPORARY TABLE bench_insert;");
+}
@@ -0,0 +1,44 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/date_time.hpp>
+#include <mariadb++/decimal.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace mariadb;
+
+// these run without server
+
+static void parseDateTime(::benchmark::State &state) {
+    const std::string text = "2024-02-29 12:34:56.123456";
+
+    for (auto _ : state) ::benchmark::DoNotOptimize(date_time(text));
+}
+BENCHMARK(parseDateTime);
+
+static void parseTime(::benchmark::State &state) {
+    const std::string text = "12:34:56.123456";
+
+    for (auto _ : state) ::benchmark::DoNotOptimize(mariadb::time(text));
+}
+BENCHMARK(parseTime);
+
+static void parseDecimal(::benchmark::State &state) {
+    const std::string text = "123456789.1234";
+
+    for (auto _ : state) ::benchmark::DoNotOptimize(decimal(text.c_str(), text.size()));
+}
+BENCHMARK(parseDecimal);
+
+static void formatDecimal(::benchmark::State &state) {
+    const decimal value(1234567891234ll, 4);
+    char buffer[decimal::max_length];
+
+    for (auto _ : state) ::benchmark::DoNotOptimize(value.format(buffer));
+}
+BENCHMARK(formatDecimal);
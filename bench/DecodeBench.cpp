@@ -0,0 +1,110 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/bind.hpp>
+#include <mariadb++/date_time.hpp>
+
+#include "DecodeColumn.h"
+#include "MockResult.h"
+
+// these run without server, rows come from a mock result in the layout of the bench_rows table
+
+namespace {
+const u32 mock_row_count = 1000;
+
+//
+// Builds the mock rows for the text or binary protocol
+//
+result_store_ref MockRows(bool binary) {
+    MockResult mock(binary);
+    mock.AddColumn("id", MYSQL_TYPE_LONG);
+    mock.AddColumn("i", MYSQL_TYPE_LONG);
+    mock.AddColumn("b", MYSQL_TYPE_LONGLONG);
+    mock.AddColumn("d", MYSQL_TYPE_DOUBLE);
+    mock.AddColumn("m", MYSQL_TYPE_NEWDECIMAL);
+    mock.AddColumn("s", MYSQL_TYPE_VAR_STRING);
+    mock.AddColumn("t", MYSQL_TYPE_DATETIME);
+
+    for (u32 row = 0; row < mock_row_count; row++) {
+        const std::string n = std::to_string(row);
+        const date_time t(2024, 2, 29, 12, 34, 56);
+
+        if (binary) {
+            mock.AddInteger(row + 1);
+            mock.AddInteger(row);
+            mock.AddInteger(row * 1000000000ll);
+            mock.AddDouble(row + 0.25);
+        } else {
+            mock.AddText(std::to_string(row + 1));
+            mock.AddText(n);
+            mock.AddText(n + "000000000");
+            mock.AddText(n + ".25");
+        }
+
+        // decimals and strings are text in both protocols
+        mock.AddText(n + ".1234");
+        mock.AddText("row number " + n);
+
+        if (binary)
+            mock.AddTime(t.add(std::chrono::microseconds(100000 + row)).mysql_time());
+        else
+            mock.AddText("2024-02-29 12:34:56." + std::to_string(100000 + row));
+    }
+
+    return mock.Store();
+}
+
+void decodeMock(::benchmark::State &state, bool binary) {
+    const u32 column = static_cast<u32>(state.range(0));
+    state.SetLabel(bench_column_names[column]);
+
+    const result_store_ref store = MockRows(binary);
+    for (auto _ : state) DecodeColumn(state, result_store::open(store), column);
+}
+}  // namespace
+
+static void decodeText(::benchmark::State &state) {
+    decodeMock(state, false);
+}
+BENCHMARK(decodeText)->DenseRange(1, 6);
+
+static void decodeBinary(::benchmark::State &state) {
+    decodeMock(state, true);
+}
+BENCHMARK(decodeBinary)->DenseRange(1, 6);
+
+static void setDateTime(::benchmark::State &state) {
+    const std::string text = "2024-02-29 12:34:56.123456";
+    date_time value;
+
+    for (auto _ : state) ::benchmark::DoNotOptimize(value.set(text));
+}
+BENCHMARK(setDateTime);
+
+static void bindString(::benchmark::State &state) {
+    const std::string text(state.range(0), 'x');
+    MYSQL_BIND raw;
+    bind b(&raw);
+
+    for (auto _ : state) {
+        b.set(MYSQL_TYPE_STRING, text.data(), static_cast<unsigned long>(text.size()));
+        ::benchmark::DoNotOptimize(b.buffer());
+    }
+}
+BENCHMARK(bindString)->Arg(8)->Arg(64)->Arg(4096);
+
+static void bindInteger(::benchmark::State &state) {
+    MYSQL_BIND raw;
+    bind b(&raw);
+
+    for (auto _ : state) {
+        b.set(MYSQL_TYPE_LONGLONG);
+        ::benchmark::DoNotOptimize(b.buffer());
+    }
+}
+BENCHMARK(bindInteger);
@@ -0,0 +1,54 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_DECODECOLUMN_H
+#define MARIADBCLIENTPP_DECODECOLUMN_H
+
+#include <mariadb++/result_set.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace mariadb;
+
+// columns of the benchmark results: id INT, i INT, b BIGINT, d DOUBLE, m DECIMAL, s VARCHAR, t DATETIME
+const char *const bench_column_names[] = {"id", "i", "b", "d", "m", "s", "t"};
+
+//
+// Decodes one column of every row with the getter matching its type
+//
+inline void DecodeColumn(::benchmark::State &state, const result_set_ref &rs, u32 column) {
+    u64 rows = 0;
+
+    while (rs->next()) {
+        switch (column) {
+            case 1:
+                ::benchmark::DoNotOptimize(rs->get_signed32(column));
+                break;
+            case 2:
+                ::benchmark::DoNotOptimize(rs->get_signed64(column));
+                break;
+            case 3:
+                ::benchmark::DoNotOptimize(rs->get_double(column));
+                break;
+            case 4:
+                ::benchmark::DoNotOptimize(rs->get_decimal(column));
+                break;
+            case 5:
+                ::benchmark::DoNotOptimize(rs->get_string(column));
+                break;
+            case 6:
+                ::benchmark::DoNotOptimize(rs->get_date_time(column));
+                break;
+        }
+
+        rows++;
+    }
+
+    state.SetItemsProcessed(state.items_processed() + rows);
+}
+
+#endif  // MARIADBCLIENTPP_DECODECOLUMN_H
@@ -0,0 +1,85 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_MOCKRESULT_H
+#define MARIADBCLIENTPP_MOCKRESULT_H
+
+#include <cstring>
+#include "result_store.hpp"
+
+using namespace mariadb;
+
+//
+// Builds a result_store from synthetic fields and cells, to run the result_set getters without
+// server. Cells are added row by row in column order, as the server would send them:
+// text for the text protocol, values in the layout of the result binds for the binary protocol
+//
+class MockResult {
+   public:
+    explicit MockResult(bool binary) : m_store(new result_store()) { m_store->m_binary = binary; }
+
+    void AddColumn(const std::string &name, enum_field_types type, unsigned int flags = 0) {
+        MYSQL_FIELD field;
+        memset(&field, 0, sizeof(field));
+        field.type = type;
+        field.flags = flags;
+
+        m_store->m_fields.push_back(field);
+        m_store->m_names.push_back(name);
+        m_store->m_field_count++;
+    }
+
+    void AddCell(const void *value, size_t length) {
+        NextCell();
+        const char *bytes = static_cast<const char *>(value);
+        m_store->m_arena.insert(m_store->m_arena.end(), bytes, bytes + length);
+    }
+
+    void AddText(const std::string &text) { AddCell(text.data(), text.size()); }
+
+    // integers are bound as 64 bit, reading fewer bytes relies on little endian like the library
+    void AddInteger(s64 value) { AddCell(&value, sizeof(value)); }
+
+    void AddDouble(f64 value) { AddCell(&value, sizeof(value)); }
+
+    void AddTime(const MYSQL_TIME &value) { AddCell(&value, sizeof(value)); }
+
+    void AddNull() {
+        const u64 cell = NextCell();
+        m_store->m_nulls[cell / 8] |= static_cast<u8>(1u << (cell % 8));
+    }
+
+    //
+    // Finishes the store, no more cells can be added
+    //
+    result_store_ref Store() {
+        // names are only stable once all columns are added
+        for (u32 i = 0; i < m_store->m_field_count; ++i) {
+            m_store->m_fields[i].name = const_cast<char *>(m_store->m_names[i].c_str());
+            m_store->m_indexes[m_store->m_names[i]] = i;
+        }
+
+        m_store->m_offsets.push_back(m_store->m_arena.size());
+        return m_store;
+    }
+
+   private:
+    u64 NextCell() {
+        const u64 cell = m_store->m_offsets.size();
+        if (cell % m_store->m_field_count == 0)
+            m_store->m_row_count++;
+
+        m_store->m_offsets.push_back(m_store->m_arena.size());
+        m_store->m_nulls.resize((cell + 8) / 8);
+        return cell;
+    }
+
+    std::shared_ptr<result_store> m_store;
+};
+
+#endif  // MARIADBCLIENTPP_MOCKRESULT_H
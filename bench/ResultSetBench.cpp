@@ -0,0 +1,27 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "SkeletonBench.h"
+#include "DecodeColumn.h"
+
+BENCHMARK_DEFINE_F(SkeletonBench, scanText)(::benchmark::State &state) {
+    const u32 column = static_cast<u32>(state.range(0));
+    state.SetLabel(bench_column_names[column]);
+
+    for (auto _ : state) DecodeColumn(state, m_con->query("SELECT * FROM bench_rows;"), column);
+}
+BENCHMARK_REGISTER_F(SkeletonBench, scanText)->DenseRange(1, 6);
+
+BENCHMARK_DEFINE_F(SkeletonBench, scanBinary)(::benchmark::State &state) {
+    const u32 column = static_cast<u32>(state.range(0));
+    state.SetLabel(bench_column_names[column]);
+
+    statement_ref stmt = m_con->create_statement("SELECT * FROM bench_rows;");
+    for (auto _ : state) DecodeColumn(state, stmt->query(), column);
+}
+BENCHMARK_REGISTER_F(SkeletonBench, scanBinary)->DenseRange(1, 6);
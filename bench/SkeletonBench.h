@@ -0,0 +1,79 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_SKELETONBENCH_H
+#define MARIADBCLIENTPP_SKELETONBENCH_H
+
+#include <mariadb++/connection.hpp>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "test_config.h"
+
+using namespace mariadb;
+
+// rows in the benchmark table
+constexpr u32 bench_row_count = 1000;
+
+class SkeletonBench : public ::benchmark::Fixture {
+   public:
+    using ::benchmark::Fixture::SetUp;
+    using ::benchmark::Fixture::TearDown;
+
+    void SetUp(const ::benchmark::State &) override {
+        using TestConfig = mariadb::testing::TestConfig;
+
+        // run_bench.sh passes the socket of its throwaway server, otherwise the test server is used
+        const char *socket = std::getenv("MARIADBPP_BENCH_SOCKET");
+        if (socket && *socket)
+            m_account = account::create("localhost", TestConfig::User, TestConfig::Password,
+                    TestConfig::Database, 0, socket);
+        else
+            m_account = account::create(TestConfig::Hostname, TestConfig::User, TestConfig::Password,
+                    TestConfig::Database, TestConfig::Port, TestConfig::UnixSocket);
+
+        m_con = connection::create(m_account);
+        if (!m_con->connect())
+            throw std::runtime_error("Cannot connect to the benchmark server");
+
+        // the table is shared by all benchmarks of the run
+        static bool created = false;
+        if (!created) {
+            CreateBenchTable();
+            created = true;
+        }
+    }
+
+    void TearDown(const ::benchmark::State &) override { m_con.reset(); }
+
+   protected:
+    void CreateBenchTable() {
+        m_con->execute("DROP TABLE IF EXISTS bench_rows;");
+        m_con->execute("CREATE TABLE bench_rows (id INT AUTO_INCREMENT, i INT, b BIGINT, d DOUBLE, "
+                       "m DECIMAL(18, 4), s VARCHAR(64), t DATETIME(6), PRIMARY KEY (id));");
+
+        std::string insert = "INSERT INTO bench_rows (i, b, d, m, s, t) VALUES ";
+        for (u32 row = 0; row < bench_row_count; row++) {
+            const std::string n = std::to_string(row);
+
+            if (row)
+                insert += ", ";
+
+            insert += "(" + n + ", " + n + "000000000, " + n + ".25, " + n + ".1234, 'row number " + n +
+                      "', '2024-02-29 12:34:56." + std::to_string(100000 + row) + "')";
+        }
+
+        m_con->execute(insert);
+    }
+
+    account_ref m_account;
+    connection_ref m_con;
+};
+
+#endif  // MARIADBCLIENTPP_SKELETONBENCH_H
@@ -153,6 +153,18 @@ public:
      */
     void set_store_result(bool store_result);
 
+    /**
+     * Gets the stream threshold in bytes. Variable sized columns of prepared statement results exceeding it are
+     * not copied into a result buffer when fetching a row. They are read on demand instead and can be streamed in
+     * chunks using result_set::get_blob. Zero disables the threshold, which is the default.
+     */
+    u64 stream_threshold() const;
+
+    /**
+     * Sets the stream threshold in bytes, zero disables it.
+     */
+    void set_stream_threshold(u64 threshold);
+
     /**
      * Gets the current value of any named option that was previously set
      *
@@ -221,6 +233,7 @@ private:
 
     bool m_auto_commit = true;
     bool m_store_result = true;
+    u64 m_stream_threshold = 0;
     u32 m_port;
     std::string m_host_name;
     std::string m_user_name;
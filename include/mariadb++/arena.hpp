@@ -0,0 +1,93 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_ARENA_HPP_
+#define _MARIADB_ARENA_HPP_
+
+#include <memory>
+#include <vector>
+
+namespace mariadb {
+/**
+ * Interface of pluggable memory sources, e.g. for data
+ */
+class allocator {
+public:
+    virtual ~allocator() = default;
+
+    /**
+     * Allocates a buffer of size bytes aligned to alignment, a power of two
+     */
+    virtual void *allocate(size_t size, size_t alignment = 1) = 0;
+
+    /**
+     * Frees a buffer previously returned by allocate
+     */
+    virtual void deallocate(void *buffer, size_t size) = 0;
+};
+
+/**
+ * Monotonic memory arena handing out buffers from a few large blocks.
+ *
+ * Memory is only released when the arena is destroyed. Blocks never move, so handed out buffers
+ * stay valid when the arena grows. New blocks grow geometrically. Buffers are packed, only the
+ * requested alignment adds padding between them.
+ */
+class arena : public allocator {
+public:
+    /**
+     * Constructs an empty arena. No memory is allocated until first use
+     *
+     * @param block_size Minimum size of the first block in bytes
+     */
+    explicit arena(size_t block_size = 256);
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    /**
+     * Makes sure the next size bytes can be allocated without allocating another block
+     */
+    void reserve(size_t size);
+
+    /**
+     * Allocates a buffer of size bytes aligned to alignment. Never returns nullptr, even for empty
+     * buffers
+     */
+    void *allocate(size_t size, size_t alignment = 1) override;
+
+    /**
+     * Does nothing, memory is released with the arena
+     */
+    void deallocate(void *buffer, size_t size) override;
+
+    /**
+     * Gets the number of bytes allocated from the system
+     */
+    size_t capacity() const;
+
+private:
+    /**
+     * Allocates a new block with at least size bytes
+     */
+    void grow(size_t size);
+
+    // allocated blocks
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    // free space of the current block
+    char *m_free;
+    // bytes left in the current block
+    size_t m_left;
+    // size of the next block
+    size_t m_next_size;
+    // total size of all blocks
+    size_t m_capacity;
+};
+}  // namespace mariadb
+
+#endif
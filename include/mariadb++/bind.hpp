@@ -12,6 +12,7 @@
 
 #include <mysql.h>
 #include <mariadb++/types.hpp>
+#include <mariadb++/arena.hpp>
 #include <mariadb++/data.hpp>
 
 namespace mariadb {
@@ -28,9 +29,10 @@ public:
     explicit bind(MYSQL_BIND *mysql_bind);
 
     /**
-     * Construct a result bind for given field type
+     * Construct a result bind for given field type, variable sized buffers of initially length bytes are taken
+     * from the arena
      */
-    bind(MYSQL_BIND *mysql_bind, MYSQL_FIELD *mysql_field);
+    bind(MYSQL_BIND *mysql_bind, const MYSQL_FIELD *mysql_field, arena &buffers, unsigned long length);
 
     /*
      * Disallow copying and moving of a bind:
@@ -47,6 +49,8 @@ public:
 
     bool is_null() const;
 
+    bool is_truncated() const;
+
     bool resize();
 
     void set(enum_field_types type, const char *buffer = nullptr, unsigned long length = 0, bool us = false);
@@ -57,8 +61,15 @@ private:
 
     my_bool m_is_null;
     my_bool m_error;
-
-    data_ref m_data;
+    // result left truncated by the last fetch, read on demand
+    bool m_deferred;
+
+    // owned buffer of variable sized parameters, short values need no allocation
+    data<char> m_data;
+    // arena providing buffers of variable sized results, nullptr for parameters
+    arena *m_arena;
+    // actual length of a result, may exceed the buffer length if truncated
+    unsigned long m_length;
 
     union {
         u64 m_unsigned64;
@@ -0,0 +1,105 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_BLOB_STREAM_HPP_
+#define _MARIADB_BLOB_STREAM_HPP_
+
+#include <istream>
+#include <streambuf>
+#include <vector>
+#include <mariadb++/result_set.hpp>
+
+namespace mariadb {
+/**
+ * Read only stream buffer over existing memory, nothing is copied
+ */
+class memory_streambuf : public std::streambuf {
+public:
+    /**
+     * Constructs the buffer over size bytes at data
+     *
+     * @param data  Memory to read from, must stay valid while the buffer is used
+     * @param size  Number of bytes to read
+     * @param owner Optional owner of the memory, kept alive by the buffer
+     */
+    memory_streambuf(const char *data, size_t size, const std::shared_ptr<const void> &owner = nullptr);
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    // keeps the memory alive, if owned by someone else
+    std::shared_ptr<const void> m_owner;
+};
+
+/**
+ * Read only stream buffer over a column of the current row of a prepared statement result.
+ * The column is fetched in chunks using mysql_stmt_fetch_column, so it never has to be copied as
+ * a whole. The buffer must not be used after the next row is fetched.
+ */
+class column_streambuf : public std::streambuf {
+public:
+    /**
+     * Constructs the buffer
+     *
+     * @param stmt       Statement holding the result
+     * @param column     Index of the column to read
+     * @param type       Buffer type of the column
+     * @param size       Total size of the column in bytes
+     * @param chunk_size Maximum number of bytes fetched at once
+     */
+    column_streambuf(const statement_data_ref &stmt, u32 column, enum_field_types type, u64 size,
+                     size_t chunk_size);
+
+protected:
+    int_type underflow() override;
+    std::streamsize showmanyc() override;
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    /**
+     * Gets the current read position within the column
+     */
+    u64 position() const;
+
+    // statement holding the result
+    statement_data_ref m_stmt;
+    // index of the column
+    u32 m_column;
+    // buffer type of the column
+    enum_field_types m_type;
+    // total size of the column
+    u64 m_size;
+    // position of the first byte of m_chunk within the column
+    u64 m_offset;
+    // currently fetched chunk
+    std::vector<char> m_chunk;
+};
+
+/**
+ * Input stream owning its stream buffer, used to return blobs as stream_ref with a single allocation
+ */
+template <typename Buffer>
+class buffer_stream : public std::istream {
+public:
+    template <typename... Args>
+    explicit buffer_stream(Args &&... args) : std::istream(nullptr), m_buffer(std::forward<Args>(args)...) {
+        rdbuf(&m_buffer);
+    }
+
+private:
+    Buffer m_buffer;
+};
+
+typedef buffer_stream<memory_streambuf> memory_stream;
+typedef buffer_stream<column_streambuf> column_stream;
+}  // namespace mariadb
+
+#endif
@@ -0,0 +1,209 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_CLUSTER_HPP_
+#define _MARIADB_CLUSTER_HPP_
+
+#include <chrono>
+#include <mariadb++/connection_pool.hpp>
+
+namespace mariadb {
+class cluster;
+class cluster_session;
+typedef std::shared_ptr<cluster> cluster_ref;
+typedef std::shared_ptr<cluster_session> cluster_session_ref;
+
+/**
+ * Read/write splitting router across one primary and any number of replicas.
+ *
+ * Every endpoint is backed by its own connection_pool. Writes and transactions are meant to be
+ * executed on connections obtained by writer(), which always routes to the primary. Read-only
+ * queries should use reader(), which picks the healthy replica with the least outstanding
+ * connections and falls back to the primary if no replica is usable.
+ */
+class cluster : public std::enable_shared_from_this<cluster> {
+    friend class cluster_session;
+
+public:
+    /**
+     * Destructs the cluster and all of its pools
+     */
+    virtual ~cluster() = default;
+
+    /**
+     * Leases a connection to the primary. Use it for writes and transactions
+     *
+     * @return Reference to the leased connection
+     */
+    connection_ref writer();
+
+    /**
+     * Leases a connection to the replica with the least outstanding connections. Replicas lagging
+     * behind more than max_replica_lag() are skipped. Falls back to the primary if there are no
+     * usable replicas
+     *
+     * @return Reference to the leased connection
+     */
+    connection_ref reader();
+
+    /**
+     * Creates a session with read-your-writes semantics: once it was used to write, its reads are
+     * routed to the primary for sticky_window() milliseconds
+     *
+     * @return Reference to the newly created session
+     */
+    cluster_session_ref create_session();
+
+    /**
+     * Gets the pool of the primary
+     */
+    const connection_pool_ref &primary() const;
+
+    /**
+     * Gets the number of replicas
+     */
+    u32 replica_count() const;
+
+    /**
+     * Gets the pool of the replica at index
+     */
+    const connection_pool_ref &replica(u32 index) const;
+
+    /**
+     * Gets the maximum tolerated replication lag in seconds. Zero disables lag checks
+     */
+    u32 max_replica_lag() const;
+
+    /**
+     * Sets the maximum tolerated replication lag in seconds. Zero disables lag checks.
+     * Note: checking the lag requires the REPLICATION CLIENT (or SLAVE MONITOR) privilege
+     */
+    void set_max_replica_lag(u32 seconds);
+
+    /**
+     * Gets the interval in milliseconds after which the lag of a replica is checked again
+     */
+    u32 lag_check_interval() const;
+
+    /**
+     * Sets the interval in milliseconds after which the lag of a replica is checked again
+     */
+    void set_lag_check_interval(u32 interval_ms);
+
+    /**
+     * Gets the duration in milliseconds a session keeps reading from the primary after a write.
+     * Zero means the session sticks to the primary for its whole lifetime
+     */
+    u32 sticky_window() const;
+
+    /**
+     * Sets the duration in milliseconds a session keeps reading from the primary after a write.
+     * Zero means the session sticks to the primary for its whole lifetime
+     */
+    void set_sticky_window(u32 window_ms);
+
+    /**
+     * Creates a new cluster
+     *
+     * @param primary  Account of the primary, used for writes and transactions
+     * @param replicas Accounts of the replicas, used for reads
+     * @param max_idle Maximum number of idle connections kept per endpoint
+     * @return Reference to the newly created cluster
+     */
+    static cluster_ref create(const account_ref &primary, const std::vector<account_ref> &replicas,
+                              u32 max_idle = 8);
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    /**
+     * Routing state of a single replica
+     */
+    struct replica_state {
+        explicit replica_state(const connection_pool_ref &pool) : m_pool(pool) {}
+
+        // pool of connections to this replica
+        connection_pool_ref m_pool;
+        // serializes lag checks
+        std::mutex m_mutex;
+        // result of the last lag check
+        std::atomic<bool> m_healthy{true};
+        // time of the last lag check, in ticks of clock
+        std::atomic<clock::rep> m_checked{0};
+    };
+
+    /**
+     * Private constructor used by create
+     */
+    cluster(const account_ref &primary, const std::vector<account_ref> &replicas, u32 max_idle);
+
+    /**
+     * Indicates whether a replica may be used for reading, refreshes its lag state if stale
+     */
+    bool usable(replica_state &replica);
+
+    // pool of the primary
+    connection_pool_ref m_primary;
+    // routing state of all replicas
+    std::vector<std::unique_ptr<replica_state>> m_replicas;
+    // rotates the first replica considered, to spread ties
+    std::atomic<u32> m_next_replica;
+
+    // maximum tolerated replication lag in seconds
+    std::atomic<u32> m_max_replica_lag;
+    // lag check interval in milliseconds
+    std::atomic<u32> m_lag_check_interval;
+    // read-your-writes window in milliseconds
+    std::atomic<u32> m_sticky_window;
+};
+
+/**
+ * Routing session providing read-your-writes consistency on top of a cluster.
+ * A session is not meant to be shared between threads.
+ */
+class cluster_session {
+    friend class cluster;
+
+public:
+    /**
+     * Leases a connection to the primary and marks the session as written
+     *
+     * @return Reference to the leased connection
+     */
+    connection_ref writer();
+
+    /**
+     * Leases a connection for reading. Routes to the primary while inside the sticky window after
+     * a write, otherwise behaves like cluster::reader()
+     *
+     * @return Reference to the leased connection
+     */
+    connection_ref reader();
+
+    /**
+     * Marks the session as written without leasing a connection, e.g. after a write that happened
+     * on a connection obtained elsewhere
+     */
+    void mark_write();
+
+private:
+    /**
+     * Private constructor used by cluster
+     */
+    explicit cluster_session(const cluster_ref &parent);
+
+    // parent cluster
+    cluster_ref m_cluster;
+    // indicates whether this session ever wrote
+    bool m_written;
+    // time of the last write
+    cluster::clock::time_point m_last_write;
+};
+}  // namespace mariadb
+
+#endif
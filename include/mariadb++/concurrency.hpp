@@ -11,6 +11,7 @@
 #ifndef _MARIADB_CONCURRENCY_HPP_
 #define _MARIADB_CONCURRENCY_HPP_
 
+#include <future>
 #include <vector>
 #include <mariadb++/account.hpp>
 #include <mariadb++/statement.hpp>
@@ -18,14 +19,105 @@
 namespace mariadb {
 namespace concurrency {
 namespace status {
-enum type { waiting, executing, succeed, failed, removed };
+enum type { waiting, executing, succeed, failed, removed, skipped, cancelled };
+}
+
+namespace overflow {
+enum policy { block, fail, drop_oldest };
 }
 
 //
-// Set account for connection
+// Queue metrics over all channels
+//
+struct queue_metrics {
+    // currently queued work
+    u64 depth;
+    // highest number of queued work seen
+    u64 peak_depth;
+    // work accepted into a queue
+    u64 submitted;
+    // work refused by a full queue
+    u64 rejected;
+    // work dropped from a full queue to make room
+    u64 dropped;
+    // work skipped because its deadline passed while queued
+    u64 expired;
+};
+
+class channel;
+typedef std::shared_ptr<channel> channel_ref;
+
+class async_transaction;
+typedef std::shared_ptr<async_transaction> async_transaction_ref;
+
+//
+// Set account for connection, connections are leased from a pool for this account
 //
 extern void set_account(account_ref &account);
 
+//
+// Bound the queue of each channel to capacity workers, 0 for unbounded (the default). When a
+// queue is full, submitting either blocks until there is room, throws exception::queue or drops
+// the oldest queued work, which ends up as status::skipped. Dropping blocks instead while all
+// queued work was already taken for execution, so the bound always holds. Work still queued
+// max_wait_ms after submission is skipped instead of executed, 0 waits forever. Unbounded queues
+// take work without locking, producers blocked on a full queue are woken when the limit changes
+//
+extern void set_queue_limit(u32 capacity, overflow::policy policy = overflow::block, u64 max_wait_ms = 0);
+
+//
+// Get the queue metrics
+//
+extern queue_metrics get_queue_metrics();
+
+//
+// Create a channel. Work submitted to a channel runs in submission order on one pooled
+// connection, which keeps its session state (temporary tables, variables, transactions).
+// Different channels run in parallel. The connection is handed back to the pool once the
+// channel is dropped and its work is done
+//
+extern channel_ref create_channel();
+
+//
+// Begin a transaction. Statements are collected and run as one job on one pooled connection
+// once committed: the transaction is committed if all of them succeed and rolled back otherwise.
+// With a channel the transaction runs on the session of the channel, in order with its other
+// work, else it runs in parallel to all other work
+//
+extern async_transaction_ref begin_transaction(isolation::level level = isolation::repeatable_read,
+                                               const channel_ref &channel = channel_ref());
+
+//
+// Asynchronous transaction, see begin_transaction
+//
+class async_transaction {
+    friend async_transaction_ref begin_transaction(isolation::level level, const channel_ref &channel);
+
+public:
+    //
+    // Queue a statement, nothing is sent before commit
+    //
+    async_transaction &execute(const std::string &query);
+
+    //
+    // Submit the transaction. The future yields the sum of affected rows on commit, or rethrows
+    // the error which caused the rollback. Throws std::logic_error if already submitted
+    //
+    std::future<u64> commit();
+
+private:
+    async_transaction(isolation::level level, const channel_ref &channel);
+
+    // isolation level the transaction is started with
+    isolation::level m_level;
+    // channel to run on, empty to run on a connection of its own
+    channel_ref m_channel;
+    // queued statements
+    std::vector<std::string> m_queries;
+    // indicates whether commit was called
+    bool m_committed;
+};
+
 //
 // Query status
 //
@@ -51,6 +143,24 @@ inline void query(const std::string &squery) {
     query(squery, false);
 }
 
+//
+// Execute a query on a channel
+//
+extern handle execute(const channel_ref &channel, const std::string &query, bool keep_handle);
+inline void execute(const channel_ref &channel, const std::string &squery) {
+    execute(channel, squery, false);
+}
+
+extern handle insert(const channel_ref &channel, const std::string &query, bool keep_handle);
+inline void insert(const channel_ref &channel, const std::string &squery) {
+    insert(channel, squery, false);
+}
+
+extern handle query(const channel_ref &channel, const std::string &query, bool keep_handle);
+inline void query(const channel_ref &channel, const std::string &squery) {
+    query(channel, squery, false);
+}
+
 //
 // Execute a query using a statement
 // Note: the void overloads are needed because it was too easy to "forget" passing keep_handle
@@ -82,10 +192,16 @@ extern result_set_ref get_query_result(handle h);
 //
 // Remove a query
 //
-// Please note, if a result_set is used, it must be done after the result_set is used...
+// Query results are materialized, they stay valid after the handle is released
 //
 extern void release_handle(handle h);
 
+//
+// Cancel a query. Queued work is not executed, running work is interrupted by KILL QUERY on a
+// side connection. Either way it ends up as status::cancelled unless it was done already
+//
+extern void cancel(handle h);
+
 //
 // Wait for a handle to signal
 //
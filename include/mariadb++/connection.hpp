@@ -11,6 +11,7 @@
 #ifndef _MARIADB_CONNECTION_HPP_
 #define _MARIADB_CONNECTION_HPP_
 
+#include <functional>
 #include <string>
 #include <mariadb++/account.hpp>
 #include <mariadb++/statement.hpp>
@@ -26,6 +27,7 @@ namespace mariadb {
  */
 class connection : public last_error {
     friend class result_set;
+    friend class result_cache;
     friend class statement;
     friend class transaction;
     friend class save_point;
@@ -49,6 +51,17 @@ public:
      */
     void disconnect();
 
+    /**
+     * Resets the session to the settings of the account: open transactions are rolled back,
+     * temporary tables, user variables and session variables are dropped, and auto commit, schema
+     * and options of the account are applied again. The charset set by set_charset() is kept.
+     * Without mysql_reset_connection() in the client library, the connection is closed instead
+     * and established again on next use.
+     *
+     * @return True on success
+     */
+    bool reset();
+
     /**
      * Indicates whether the connection is active. Also detects stale connections
      *
@@ -123,6 +136,46 @@ public:
      */
     result_set_ref query(const std::string &query);
 
+    /**
+     * Non-throwing variants of execute(), insert() and query() for failures which are expected,
+     * such as duplicate keys, lock wait timeouts or a lost connection. Errors of the query and of
+     * establishing the connection are returned instead of thrown. Like thrown errors, they are
+     * passed to the error log.
+     *
+     * @param query SQL query to execute
+     * @return Result of the call or the error of the query
+     */
+    expected<u64> try_execute(const std::string &query);
+    expected<u64> try_insert(const std::string &query);
+    expected<result_set_ref> try_query(const std::string &query);
+
+    /**
+     * Gets the server thread id of this connection, as used by KILL
+     *
+     * @return Thread id, 0 if not connected
+     */
+    u64 thread_id() const;
+
+    /**
+     * Gets the timeout of calls on this connection
+     *
+     * @return Timeout in milliseconds, 0 if calls never time out
+     */
+    u64 query_timeout() const;
+
+    /**
+     * Sets the timeout for each following call of execute, insert, query and of statements of this
+     * connection. A call running longer is interrupted by KILL QUERY on a side connection and
+     * throws exception::timeout, this connection stays usable.
+     * Unlike MYSQL_OPT_READ_TIMEOUT this does not close the connection.
+     * The timeout covers the call including storing its result. Rows of an unbuffered result set
+     * (see account::set_store_result) are fetched by result_set::next() after the call returned
+     * and are not bounded by it.
+     *
+     * @param timeout_ms Timeout in milliseconds, 0 to disable
+     */
+    void set_query_timeout(u64 timeout_ms);
+
     /**
      * Gets the status of the auto_commit setting.
      *
@@ -165,12 +218,31 @@ public:
      * repeatable read
      * @param consistent_snapshot Indicates whether to require a consistent snapshot before entering
      * the transaction.
+     * @param read_only Indicates whether to start the transaction READ ONLY, which lets the server
+     * skip bookkeeping for writes and rejects any change to tables
      * Note: refer to MariaDB manual for further information
      *
+     * The isolation level only applies to this transaction, the session keeps its own. The level
+     * and the start are sent in one round trip, after connect() has checked the connection.
+     *
      * @return Reference to the created transaction.
      */
     transaction_ref create_transaction(isolation::level level = isolation::repeatable_read,
-                                       bool consistent_snapshot = true);
+                                       bool consistent_snapshot = true, bool read_only = false);
+
+    /**
+     * Runs fn in a new transaction and commits it. If the server aborts the transaction with a
+     * deadlock (1213) or lock wait timeout (1205), either inside fn or on commit, the transaction is
+     * rolled back and fn is run again in a new one after a random delay, up to the given number of
+     * attempts. Any other exception is passed on after rolling back.
+     * Note: fn may run more than once and should not have side effects outside of the database
+     *
+     * @param fn Work to run, receives the transaction of the current attempt
+     * @param policy Number of attempts, delays and transaction settings
+     * @return Number of attempts taken, 0 if the connection could not be established
+     */
+    u32 run_in_transaction(const std::function<void(transaction &)> &fn,
+                           const retry_policy &policy = retry_policy());
 
     /**
      * Creates a new connection using the given account
@@ -186,6 +258,42 @@ private:
      */
     connection(const account_ref &account);
 
+    /**
+     * Like connect(), but fills error and returns false on failure if error is given
+     */
+    bool connect(error_info *error);
+
+    /**
+     * Implementation of the throwing and non-throwing calls: fills error and returns false on
+     * failure if error is given, throws otherwise
+     */
+    bool run_execute(const std::string &query, u64 &affected_rows, error_info *error);
+    bool run_insert(const std::string &query, u64 &id, error_info *error);
+    bool run_query(const std::string &query, result_set_ref &result, error_info *error);
+
+    /**
+     * Runs one or more statements on the established connection, implements run_execute()
+     */
+    bool run_statements(const std::string &query, u64 &affected_rows, error_info *error);
+
+    /**
+     * Applies auto commit, schema and options of the account to a new session
+     *
+     * @return True on success
+     */
+    bool setup_session();
+
+    /**
+     * Commits the current transaction, throws exception::connection on failure
+     */
+    void commit_transaction();
+
+    /**
+     * Builds a prefix for cache keys, identifying the server, user, schema and charset results of
+     * this connection depend on
+     */
+    std::string cache_scope() const;
+
 private:
     // internal database connection pointer
     MYSQL *m_mysql;
@@ -198,6 +306,10 @@ private:
     std::string m_charset;
     // currently used account
     account_ref m_account;
+    // timeout of calls in milliseconds, 0 if disabled
+    u64 m_query_timeout;
+    // server thread id of the session the settings of the account were applied to
+    u64 m_session_id;
 };
 }  // namespace mariadb
 
@@ -0,0 +1,125 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_CONNECTION_POOL_HPP_
+#define _MARIADB_CONNECTION_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <mariadb++/connection.hpp>
+
+namespace mariadb {
+class connection_pool;
+typedef std::shared_ptr<connection_pool> connection_pool_ref;
+
+/**
+ * Thread safe pool of connections to the endpoint described by one account.
+ *
+ * Connections handed out by acquire() are leased: as soon as the last reference to a leased
+ * connection is dropped, it is handed back to the pool instead of being disconnected. Connections
+ * are established lazily on first use, so acquiring a connection does not cause a round-trip.
+ */
+class connection_pool : public std::enable_shared_from_this<connection_pool> {
+public:
+    /**
+     * Destroys the pool. Idle connections are disconnected, leased connections are disconnected
+     * when they are released.
+     */
+    virtual ~connection_pool();
+
+    /**
+     * Leases a connection from the pool, reusing an idle one if possible. If a maximum size is set
+     * and reached, blocks until another connection is released.
+     *
+     * @return Reference to the leased connection
+     */
+    connection_ref acquire();
+
+    /**
+     * Gets the account the connections of this pool are created with
+     */
+    const account_ref &account() const;
+
+    /**
+     * Gets the number of connections currently leased from this pool
+     */
+    u32 outstanding() const;
+
+    /**
+     * Gets the number of idle connections kept by this pool
+     */
+    u32 idle() const;
+
+    /**
+     * Gets the maximum number of idle connections kept for reuse
+     */
+    u32 max_idle() const;
+
+    /**
+     * Sets the maximum number of idle connections kept for reuse. Surplus connections are
+     * disconnected on release
+     */
+    void set_max_idle(u32 max_idle);
+
+    /**
+     * Gets the maximum number of concurrently leased connections, zero means unlimited
+     */
+    u32 max_size() const;
+
+    /**
+     * Sets the maximum number of concurrently leased connections, zero means unlimited
+     */
+    void set_max_size(u32 max_size);
+
+    /**
+     * Disconnects and removes all idle connections
+     */
+    void clear();
+
+    /**
+     * Creates a new connection pool for the given account
+     *
+     * @param account  The account used to create connections
+     * @param max_idle Maximum number of idle connections kept for reuse
+     * @param max_size Maximum number of concurrently leased connections, zero means unlimited
+     * @return Reference to the newly created pool
+     */
+    static connection_pool_ref create(const account_ref &account, u32 max_idle = 8, u32 max_size = 0);
+
+private:
+    /**
+     * Private constructor used by create
+     */
+    connection_pool(const account_ref &account, u32 max_idle, u32 max_size);
+
+    /**
+     * Hands a leased connection back to the pool
+     */
+    void release(const connection_ref &conn);
+
+    // account used to create connections
+    account_ref m_account;
+    // maximum number of idle connections
+    u32 m_max_idle;
+    // maximum number of leased connections
+    u32 m_max_size;
+    // number of currently leased connections
+    std::atomic<u32> m_outstanding;
+
+    // protects idle list and limits
+    mutable std::mutex m_mutex;
+    // signaled whenever a connection is released
+    std::condition_variable m_released;
+    // connections available for reuse
+    std::vector<connection_ref> m_idle;
+};
+}  // namespace mariadb
+
+#endif
@@ -12,7 +12,9 @@
 #define _MARIADB_DATA_HPP_
 
 #include <string.h>
+#include <algorithm>
 #include <mariadb++/types.hpp>
+#include <mariadb++/arena.hpp>
 #include <iostream>
 
 namespace mariadb {
@@ -24,14 +26,67 @@ public:
     //
     // Constructor
     //
-    data() : m_count(0), m_size(0), m_data(0) {}
+    data() : m_allocator(nullptr) {
+        reset();
+    }
 
-    data(u32 count) : m_count(0), m_size(0), m_data(0) {
+    data(size_t count) : m_allocator(nullptr) {
+        reset();
         create(count);
     }
 
-    data(const Type *data, size_t count) : m_count(0), m_size(0), m_data(0) {
-        create(data, static_cast<u32>(count));
+    data(const Type *data, size_t count) : m_allocator(nullptr) {
+        reset();
+        create(data, count);
+    }
+
+    //
+    // Constructor taking memory from alloc, which has to outlive this data
+    //
+    data(size_t count, allocator &alloc) : m_allocator(&alloc) {
+        reset();
+        create(count);
+    }
+
+    data(const Type *data, size_t count, allocator &alloc) : m_allocator(&alloc) {
+        reset();
+        create(data, count);
+    }
+
+    //
+    // Copy creates an owned copy of the contents on the heap, even of wrapped or allocator backed
+    // memory, as the allocator of other may not outlive the copy
+    //
+    data(const data &other) : m_allocator(nullptr) {
+        reset();
+        create(other.m_data, other.m_count);
+        m_position = other.m_position;
+    }
+
+    data(data &&other) noexcept : m_allocator(other.m_allocator) {
+        reset();
+        take(other);
+    }
+
+    data &operator=(const data &other) {
+        if (this != &other) {
+            destroy();
+            m_allocator = nullptr;
+            create(other.m_data, other.m_count);
+            m_position = other.m_position;
+        }
+
+        return *this;
+    }
+
+    data &operator=(data &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            m_allocator = other.m_allocator;
+            take(other);
+        }
+
+        return *this;
     }
 
     //
@@ -41,48 +96,71 @@ public:
         destroy();
     }
 
+    //
+    // Wrap externally owned memory without copying. The memory has to outlive the data,
+    // growing beyond count moves the contents into owned memory
+    //
+    static std::shared_ptr<data> wrap(Type *buffer, size_t count) {
+        std::shared_ptr<data> result(new data());
+        result->m_data = buffer;
+        result->m_count = result->m_capacity = count;
+        result->m_size = sizeof(Type) * count;
+        result->m_owned = false;
+        return result;
+    }
+
     //
     // Create the data
     //
-    bool create(u32 count) {
+    bool create(size_t count) {
         if (m_data)
             destroy();
 
-        m_data = new Type[count];
+        m_data = allocate(count);
 
         if (m_data == 0)
             return false;
 
-        m_count = count;
+        m_count = m_capacity = count;
         m_size = sizeof(Type) * count;
         m_position = 0;
 
         return true;
     }
 
-    bool create(const Type *data, u32 count) {
+    bool create(const Type *data, size_t count) {
         if (create(count)) {
-            memcpy(m_data, data, m_size);
+            if (m_size)
+                memcpy(m_data, data, m_size);
             return true;
         }
 
         return false;
     }
 
-    bool resize(u32 count) {
-        if (count > m_count) {
-            Type *data = new Type[count];
+    //
+    // Resize the data, keeping its contents. Only reallocates when growing beyond the capacity
+    //
+    bool resize(size_t count) {
+        if (count > m_capacity) {
+            Type *data = allocate(count);
 
             if (data == 0)
                 return false;
 
-            memcpy(data, m_data, m_size);
-            delete[] m_data;
+            if (m_size && data != m_data)
+                memcpy(data, m_data, m_size);
+            if (data != m_data)
+                release();
+
             m_data = data;
+            m_capacity = count;
+            m_owned = true;
         }
 
         m_count = count;
         m_size = sizeof(Type) * count;
+        m_position = std::min(m_position, m_size);
 
         return true;
     }
@@ -91,13 +169,8 @@ public:
     // Destroy
     //
     void destroy() {
-        if (m_data)
-            delete[] m_data;
-
-        m_data = NULL;
-        m_size = 0;
-        m_count = 0;
-        m_position = 0;
+        release();
+        reset();
     }
 
     //
@@ -111,11 +184,14 @@ public:
     }
 
     //
-    // Get data / size
+    // Get data / size / capacity
     //
-    inline u32 size() const {
+    inline size_t size() const {
         return m_size;
     }
+    inline size_t capacity() const {
+        return m_capacity;
+    }
     inline Type *get() const {
         return m_data;
     }
@@ -165,24 +241,94 @@ public:
         if (seekdir == std::ios_base::beg)
             pos = offset;
         else if (seekdir == std::ios_base::cur)
-            pos = m_position + offset;
+            pos = static_cast<std::streamoff>(m_position) + offset;
         else if (seekdir == std::ios_base::end)
-            pos = m_size + offset;
+            pos = static_cast<std::streamoff>(m_size) + offset;
         else
             throw std::ios_base::failure("Bad seek direction");
 
-        if (pos < 0 || pos > m_size)
+        if (pos < 0 || pos > static_cast<std::streamoff>(m_size))
             throw std::ios_base::failure("Bad seek offset");
 
-        m_position = static_cast<u32>(pos);
+        m_position = static_cast<size_t>(pos);
         return pos;
     }
 
 protected:
-    u32 m_count;
-    u32 m_size;
-    u32 m_position;
+    // number of elements stored without a separate allocation
+    static const size_t inline_count = sizeof(Type) < 32 ? 32 / sizeof(Type) : 1;
+
+    //
+    // Get memory for count elements, short values use the inline buffer
+    //
+    Type *allocate(size_t count) {
+        if (count <= inline_count)
+            return inline_buffer();
+
+        if (m_allocator)
+            return static_cast<Type *>(m_allocator->allocate(sizeof(Type) * count, alignof(Type)));
+
+        return new Type[count];
+    }
+
+    //
+    // Free the memory, if owned
+    //
+    void release() {
+        if (!m_data || !m_owned || m_data == inline_buffer())
+            return;
+
+        if (m_allocator)
+            m_allocator->deallocate(m_data, sizeof(Type) * m_capacity);
+        else
+            delete[] m_data;
+    }
+
+    //
+    // Reset to empty, without freeing
+    //
+    void reset() {
+        m_data = nullptr;
+        m_count = 0;
+        m_capacity = 0;
+        m_size = 0;
+        m_position = 0;
+        m_owned = true;
+    }
+
+    //
+    // Take over the contents of other, leaving it empty
+    //
+    void take(data &other) {
+        if (other.m_data == other.inline_buffer()) {
+            m_data = inline_buffer();
+            memcpy(m_data, other.m_data, other.m_size);
+        } else
+            m_data = other.m_data;
+
+        m_count = other.m_count;
+        m_capacity = other.m_capacity;
+        m_size = other.m_size;
+        m_position = other.m_position;
+        m_owned = other.m_owned;
+        other.reset();
+    }
+
+    Type *inline_buffer() {
+        return reinterpret_cast<Type *>(m_inline);
+    }
+
+    size_t m_count;
+    size_t m_capacity;
+    size_t m_size;
+    size_t m_position;
     Type *m_data;
+    // optional memory source, nullptr for the heap
+    allocator *m_allocator;
+    // indicates whether m_data is freed by this data
+    bool m_owned;
+    // storage of short values
+    alignas(Type) char m_inline[sizeof(Type) * inline_count];
 };
 
 typedef std::shared_ptr< ::mariadb::data<char> > data_ref;
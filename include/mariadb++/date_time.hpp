@@ -55,7 +55,7 @@ public:
     date_time(const tm &time_struct);
 
     /**
-     * Construct date_time from given time_t. Converts the time to local timezone before setting it.
+     * Construct date_time from given time_t, taken as UTC. Does not depend on the timezone.
      * Note that no milliseconds will be set.
      *
      * @param time Timetype to set.
@@ -63,12 +63,20 @@ public:
     date_time(const time_t &time);
 
     /**
-     * Construct date_time from MYSQL_TIME. No milliseconds will be set.
+     * Construct date_time from MYSQL_TIME, keeping microseconds.
      *
      * @param time MYSQL_TIME to copy from.
      */
     date_time(const MYSQL_TIME &time);
 
+    /**
+     * Construct date_time from a point in time of the system clock, keeping microseconds. The
+     * date and time are those of UTC
+     *
+     * @param time_point Point in time to convert
+     */
+    explicit date_time(const std::chrono::system_clock::time_point &time_point);
+
     /**
      * Construct date_time from ISO yyyy-mm-dd hh:mm:ss.nnn date format. Throws an exception on
      * invalid input
@@ -237,6 +245,14 @@ public:
      */
     date_time add_milliseconds(s32 milliseconds) const;
 
+    /**
+     * Adds a duration to the date_time with day wrapping. Negative values subtract
+     *
+     * @param dur The duration to add
+     * @return Newly created date_time containing result
+     */
+    date_time add(const std::chrono::microseconds &dur) const;
+
     /**
      * Adds a timespan to the date_time.
      *
@@ -341,14 +357,40 @@ public:
     static date_time reverse_day_of_year(u16 year, u16 day_of_year);
 
     /**
-     * Convert the date_time to a time_t. Precision is limited to seconds
+     * Gets the number of days since 1970-01-01 of a date of the proleptic gregorian calendar. Constant time
+     *
+     * @param year Year of date
+     * @param month Month of date
+     * @param day Day of date
+     * @return Days since epoch, negative before
+     */
+    static s64 days_from_civil(s32 year, u32 month, u32 day);
+
+    /**
+     * Gets the date a number of days after 1970-01-01. Constant time
+     *
+     * @param days Days since epoch, negative before
+     * @return Datetime representing the date at midnight
+     */
+    static date_time civil_from_days(s64 days);
+
+    /**
+     * Convert the date_time, taken as UTC, to a time_t. Precision is limited to seconds
      *
      * @return Timetype representing the date_time
      */
     time_t mktime() const;
 
     /**
-     * Uses ::difftime to calculate number of seconds between two dates
+     * Convert the date_time, taken as local time, to a time_t using time.h. This takes the
+     * timezone lock of the C library. Precision is limited to seconds
+     *
+     * @return Timetype representing the date_time
+     */
+    time_t mktime_local() const;
+
+    /**
+     * Calculates the number of seconds between two dates
      *
      * @param dt Datetime to calculate difference to
      * @return Number of seconds with fractions between the two dates
@@ -363,26 +405,53 @@ public:
     date_time date() const;
 
     /**
-     * Converts the date_time to a MYSQL_TIME. Precision is limited to seconds
+     * Converts the date_time to a MYSQL_TIME, including microseconds
      *
      * @return MYSQL_TIME representing this date_time
      */
     MYSQL_TIME mysql_time() const;
 
     /**
-     * Gets the current date and time as date_time. Does not set milliseconds
+     * Converts the date_time, taken as UTC, to a point in time of the system clock. The date must
+     * be within the range of the system clock
+     *
+     * @return Point in time with microsecond precision
+     */
+    std::chrono::system_clock::time_point time_point() const;
+
+    /**
+     * Sets date and time from a point in time of the system clock, as UTC, keeping microseconds
+     *
+     * @param time_point Point in time to set
+     * @return Newly set point in time
+     */
+    std::chrono::system_clock::time_point time_point(const std::chrono::system_clock::time_point &time_point);
+
+    /**
+     * Gets the current date and time as date_time with microseconds. This takes the timezone lock
+     * of the C library, prefer now_utc() where possible
      *
      * @return Current date and time in local timezone
      */
     static date_time now();
 
     /**
-     * Gets the current date and time as date_time. Does not set milliseconds
+     * Gets the current date and time as date_time with microseconds from the realtime clock,
+     * without consulting the timezone
      *
      * @return Current date and time in UTC
      */
     static date_time now_utc();
 
+    /**
+     * Converts a time_t to the local timezone using time.h. This takes the timezone lock of the C
+     * library. Note that no milliseconds will be set.
+     *
+     * @param time Seconds since the epoch
+     * @return Date and time in the local timezone
+     */
+    static date_time from_local_time(const time_t &time);
+
     /**
      * Converts the date and time to ISO 8601 string yyyy-mm-dd hh:mm:ss[.nnn]
      *
@@ -399,6 +468,16 @@ public:
     const std::string str_date() const;
 
 private:
+    /**
+     * Gets the signed duration from dt to this
+     */
+    std::chrono::microseconds duration_since(const date_time &dt) const;
+
+    /**
+     * Sets date and time from a number of microseconds since the epoch, as UTC
+     */
+    void set_since_epoch(s64 us);
+
     u16 m_year;
     u8 m_month;
     u8 m_day;
@@ -14,24 +14,120 @@
 #include <mariadb++/conversion_helper.hpp>
 
 namespace mariadb {
+/**
+ * Fixed point decimal, stored as 64 bit integer scaled by a power of ten.
+ *
+ * Values with up to 18 significant digits are represented exactly and support exact arithmetic
+ * and comparison. Longer values, or text that is no plain decimal number, are kept as text: they
+ * can be converted and bound as before, but not calculated with.
+ */
 class decimal {
 public:
-    explicit decimal(std::string str = "") : mStr(std::move(str)) {}
+    // maximum number of fractional digits
+    static const u8 max_scale = 38;
+    // buffer size sufficient for format()
+    static const size_t max_length = 48;
 
-    std::string str() const {
-        return mStr;
-    }
+    /**
+     * Constructs an exact zero
+     */
+    decimal();
 
-    f32 float32() const {
-        return string_cast<f32>(mStr);
-    }
+    /**
+     * Parses a decimal from its text representation, empty text is an exact zero
+     */
+    explicit decimal(const std::string &str);
 
-    f64 double64() const {
-        return string_cast<f64>(mStr);
-    }
+    /**
+     * Parses a decimal from length characters at str, without allocating if the value is exact.
+     * Empty text, as read from NULL columns, is an exact zero
+     */
+    decimal(const char *str, size_t length);
+
+    /**
+     * Constructs the decimal unscaled * 10^-scale
+     */
+    decimal(s64 unscaled, u8 scale);
+
+    /**
+     * Gets the text representation, with exactly scale() fractional digits
+     */
+    std::string str() const;
+
+    /**
+     * Writes the text representation of an exact decimal to buffer, which must hold max_length
+     * characters. No terminating zero is written
+     *
+     * @return Number of characters written
+     */
+    size_t format(char *buffer) const;
+
+    f32 float32() const;
+
+    f64 double64() const;
+
+    /**
+     * Indicates whether the value is represented exactly as scaled integer
+     */
+    bool is_exact() const;
+
+    /**
+     * Gets the scaled integer value
+     */
+    s64 unscaled() const;
+
+    /**
+     * Gets the number of fractional digits
+     */
+    u8 scale() const;
+
+    /**
+     * Gets the value with a different number of fractional digits, rounded half away from zero
+     */
+    decimal rescale(u8 scale) const;
+
+    /**
+     * Compares two exact decimals of any scale
+     *
+     * @return Negative, zero or positive if this is less than, equal to or greater than other
+     */
+    int compare(const decimal &other) const;
+
+    decimal operator-() const;
+    decimal operator+(const decimal &other) const;
+    decimal operator-(const decimal &other) const;
+    decimal operator*(const decimal &other) const;
+
+    decimal &operator+=(const decimal &other);
+    decimal &operator-=(const decimal &other);
+    decimal &operator*=(const decimal &other);
+
+    bool operator==(const decimal &other) const;
+    bool operator!=(const decimal &other) const;
+    bool operator<(const decimal &other) const;
+    bool operator<=(const decimal &other) const;
+    bool operator>(const decimal &other) const;
+    bool operator>=(const decimal &other) const;
 
 private:
-    std::string mStr;
+    /**
+     * Parses str, keeps the text if it cannot be represented exactly
+     */
+    void parse(const char *str, size_t length);
+
+    /**
+     * Throws if the value is not exact
+     */
+    void check_exact() const;
+
+    // scaled value
+    s64 m_value;
+    // number of fractional digits
+    u8 m_scale;
+    // indicates if m_value and m_scale represent the value
+    bool m_exact;
+    // text representation of values that are not exact
+    std::string m_text;
 };
 }  // namespace mariadb
 
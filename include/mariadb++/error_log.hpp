@@ -0,0 +1,60 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_ERROR_LOG_HPP_
+#define _MARIADB_ERROR_LOG_HPP_
+
+#include <functional>
+#include <string>
+#include <mariadb++/types.hpp>
+
+namespace mariadb {
+namespace error_log {
+/**
+ * Describes one error raised by the library, right before its exception is thrown or it is
+ * returned by a non-throwing try_ call
+ */
+struct record {
+    // error number of the server or client library, 0 for errors of mariadb++ itself
+    u32 error_no;
+    // error message
+    std::string message;
+    // server thread id of the connection, 0 if unknown
+    u64 connection_id;
+    // fingerprint of the failing SQL, see tracing::fingerprint(), 0 if unknown
+    u64 fingerprint;
+    // function, file and line raising the error
+    const char *function;
+    const char *file;
+    u32 line;
+    // number of errors dropped by the rate limit since the previous record
+    u64 suppressed;
+};
+
+typedef std::function<void(const record &)> sink;
+
+/**
+ * Sets the sink receiving errors, an empty sink disables error logging. Sinks are called on the
+ * thread raising the error, possibly concurrently, and must not throw.
+ *
+ * By default no sink is set and errors are only reported by their exceptions.
+ *
+ * @param s Sink to call
+ * @param max_per_second Maximum number of records passed to the sink per second, 0 for no limit.
+ * Dropped records are counted in the suppressed field of the next one passed
+ */
+void set_sink(const sink &s, u32 max_per_second = 10);
+
+/**
+ * Gets a sink writing records to std::cerr, one line each
+ */
+sink stderr_sink();
+}  // namespace error_log
+}  // namespace mariadb
+
+#endif
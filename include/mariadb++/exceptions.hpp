@@ -15,17 +15,60 @@
 #include <mariadb++/types.hpp>
 
 namespace mariadb {
+//
+// Kind of an error, for deciding how to react without knowing error numbers
+//
+namespace error_category {
+enum type {
+    // no error
+    none = 0,
+    // any error not covered below
+    other,
+    // connection lost or could not be established
+    connection_lost,
+    // transaction rolled back to resolve a deadlock
+    deadlock,
+    // lock wait timeout exceeded
+    lock_wait_timeout,
+    // duplicate entry for a unique key
+    duplicate_key,
+    // SQL syntax error
+    syntax,
+    // query interrupted by a timeout or cancellation
+    timeout,
+    // server is shutting down
+    server_shutdown
+};
+
+//
+// Classifies an error number of the server or client library, 0 is none
+//
+type classify(u32 error_no) throw();
+
+//
+// Indicates whether errors of the category are transient, so that retrying the work may succeed
+//
+bool transient(type category) throw();
+}  // namespace error_category
+
 namespace exception {
 class base : public std::exception {
 public:
     //
     // Constructor
     //
-    base() throw() : std::exception(), m_error_id(0), m_error("Exception not defined") {}
+    base() throw()
+        : std::exception(), m_error_id(0), m_error("Exception not defined"), m_category(error_category::other) {}
 
-    base(u32 error_id, const std::string &error) throw() : std::exception(), m_error_id(error_id), m_error(error) {}
+    base(u32 error_id, const std::string &error, const std::string &sqlstate = std::string()) throw()
+        : std::exception(),
+          m_error_id(error_id),
+          m_error(error),
+          m_sqlstate(sqlstate),
+          m_category(error_id ? error_category::classify(error_id) : error_category::other) {}
 
-    base(const std::string &error) throw() : std::exception(), m_error_id(0), m_error(error) {}
+    base(const std::string &error) throw()
+        : std::exception(), m_error_id(0), m_error(error), m_category(error_category::other) {}
 
     //
     // Destructor
@@ -43,9 +86,29 @@ public:
         return m_error_id;
     }
 
+    //
+    // Five character SQLSTATE of server and client library errors, empty otherwise
+    //
+    const std::string &sqlstate() const throw() {
+        return m_sqlstate;
+    }
+
+    error_category::type category() const throw() {
+        return m_category;
+    }
+
+    //
+    // Indicates whether retrying the work may succeed
+    //
+    bool transient() const throw() {
+        return error_category::transient(m_category);
+    }
+
 protected:
     u32 m_error_id;
     std::string m_error;
+    std::string m_sqlstate;
+    error_category::type m_category;
 };
 
 class date_time : public base {
@@ -69,7 +132,8 @@ public:
     //
     // Constructor
     //
-    connection(u32 error_id, const std::string &error) throw() : base(error_id, error) {}
+    connection(u32 error_id, const std::string &error, const std::string &sqlstate = std::string()) throw()
+        : base(error_id, error, sqlstate) {}
 };
 
 class statement : public base {
@@ -77,7 +141,27 @@ public:
     //
     // Constructor
     //
-    statement(u32 error_id, const std::string &error) throw() : base(error_id, error) {}
+    statement(u32 error_id, const std::string &error, const std::string &sqlstate = std::string()) throw()
+        : base(error_id, error, sqlstate) {}
+};
+
+class timeout : public base {
+public:
+    //
+    // Constructor
+    //
+    timeout(u32 error_id, const std::string &error, const std::string &sqlstate = std::string()) throw()
+        : base(error_id, error, sqlstate) {
+        m_category = error_category::timeout;
+    }
+};
+
+class queue : public base {
+public:
+    //
+    // Constructor
+    //
+    queue(const std::string &error) throw() : base(error) {}
 };
 }  // namespace exception
 }  // namespace mariadb
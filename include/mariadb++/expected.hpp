@@ -0,0 +1,143 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_EXPECTED_HPP_
+#define _MARIADB_EXPECTED_HPP_
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <mariadb++/exceptions.hpp>
+
+namespace mariadb {
+//
+// Exception the throwing variant of a call raises for an error
+//
+namespace exception_type {
+enum type { base = 0, connection, statement, timeout, out_of_range };
+}
+
+/**
+ * Describes an error returned by the non-throwing try_* functions
+ */
+struct error_info {
+    // error number of the server or client library, 0 for errors of mariadb++ itself
+    u32 error_no = 0;
+    // error message
+    std::string message;
+    // five character SQLSTATE of server and client library errors, empty otherwise
+    std::string sqlstate;
+    // kind of the error
+    error_category::type category = error_category::none;
+    // exception raised for the error by the throwing call and by expected::value()
+    exception_type::type thrown = exception_type::base;
+
+    /**
+     * Indicates whether retrying the work may succeed
+     */
+    bool transient() const {
+        return error_category::transient(category);
+    }
+};
+
+/**
+ * Either a value or the error preventing it, returned by the non-throwing try_* functions
+ */
+template <typename T>
+class expected {
+public:
+    expected(const T &value) : m_value(value), m_has_value(true) {}
+
+    expected(T &&value) : m_value(std::move(value)), m_has_value(true) {}
+
+    expected(const error_info &error) : m_value(), m_error(error), m_has_value(false) {}
+
+    expected(error_info &&error) : m_value(), m_error(std::move(error)), m_has_value(false) {}
+
+    /**
+     * Indicates whether there is a value
+     */
+    bool has_value() const {
+        return m_has_value;
+    }
+
+    explicit operator bool() const {
+        return m_has_value;
+    }
+
+    /**
+     * Gets the value, throws the exception the throwing call would have raised if there is none
+     */
+    const T &value() const {
+        check();
+        return m_value;
+    }
+
+    T &value() {
+        check();
+        return m_value;
+    }
+
+    const T &operator*() const {
+        return value();
+    }
+
+    T &operator*() {
+        return value();
+    }
+
+    const T *operator->() const {
+        return &value();
+    }
+
+    T *operator->() {
+        return &value();
+    }
+
+    /**
+     * Gets the value or fallback if there is none
+     */
+    T value_or(const T &fallback) const {
+        return m_has_value ? m_value : fallback;
+    }
+
+    /**
+     * Gets the error, only valid if there is no value
+     */
+    const error_info &error() const {
+        return m_error;
+    }
+
+private:
+    void check() const {
+        if (m_has_value)
+            return;
+
+        switch (m_error.thrown) {
+            case exception_type::connection:
+                throw exception::connection(m_error.error_no, m_error.message, m_error.sqlstate);
+            case exception_type::statement:
+                throw exception::statement(m_error.error_no, m_error.message, m_error.sqlstate);
+            case exception_type::timeout:
+                throw exception::timeout(m_error.error_no, m_error.message, m_error.sqlstate);
+            case exception_type::out_of_range:
+                throw std::out_of_range(m_error.message);
+            default:
+                throw exception::base(m_error.error_no, m_error.message, m_error.sqlstate);
+        }
+    }
+
+    // value, default constructed on error
+    T m_value;
+    // error, empty if there is a value
+    error_info m_error;
+    bool m_has_value;
+};
+}  // namespace mariadb
+
+#endif
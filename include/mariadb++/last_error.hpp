@@ -12,6 +12,7 @@
 
 #include <string>
 #include "types.hpp"
+#include "exceptions.hpp"
 
 namespace mariadb {
 class last_error {
@@ -26,10 +27,13 @@ public:
     //
     u32 error_no() const;
     const std::string &error() const;
+    const std::string &sqlstate() const;
+    error_category::type category() const;
 
 protected:
     u32 m_last_error_no;
     std::string m_last_error;
+    std::string m_last_sqlstate;
 };
 }  // namespace mariadb
 
@@ -0,0 +1,173 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_METRICS_HPP_
+#define _MARIADB_METRICS_HPP_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <mariadb++/types.hpp>
+
+namespace mariadb {
+namespace metrics {
+/**
+ * Latency histogram in the style of HDR histograms: every power of two is split into 16 linear
+ * sub-buckets, so values from 1 ns up to about 73 minutes are kept with less than 6.25% relative
+ * error in a fixed number of buckets. Longer values are counted in the last bucket.
+ */
+class histogram {
+public:
+    // number of linear sub-buckets per power of two, as bits
+    static const u32 sub_bucket_bits = 4;
+    // total number of buckets
+    static const u32 bucket_count = 624;
+
+    histogram();
+
+    /**
+     * Constructs a histogram from bucket counts
+     *
+     * @param buckets Number of values per bucket, bucket_count entries
+     * @param sum Sum of all values
+     * @param max Largest value
+     */
+    histogram(const std::vector<u64> &buckets, u64 sum, u64 max);
+
+    /**
+     * Records a value count times
+     */
+    void record(u64 value, u64 count = 1);
+
+    /**
+     * Adds all values recorded by other
+     */
+    void merge(const histogram &other);
+
+    /**
+     * Gets the number of recorded values
+     */
+    u64 count() const;
+
+    /**
+     * Gets the sum of all recorded values
+     */
+    u64 sum() const;
+
+    /**
+     * Gets the largest recorded value
+     */
+    u64 max() const;
+
+    /**
+     * Gets the value below or at which the given percentage of the recorded values lie, accurate
+     * to the bucket width
+     *
+     * @param percent Percentile 0-100
+     * @return Upper bound of the bucket holding the percentile, 0 if empty
+     */
+    u64 percentile(f64 percent) const;
+
+    /**
+     * Gets the number of values recorded in a bucket
+     */
+    u64 bucket(u32 index) const;
+
+    /**
+     * Gets the index of the bucket a value is recorded in
+     */
+    static u32 bucket_index(u64 value);
+
+    /**
+     * Gets the largest value recorded in the bucket at index
+     */
+    static u64 bucket_upper_bound(u32 index);
+
+private:
+    // values per bucket
+    std::vector<u64> m_buckets;
+    // number of values
+    u64 m_count;
+    // sum of values
+    u64 m_sum;
+    // largest value
+    u64 m_max;
+};
+
+/**
+ * Metrics of one kind of operation. Durations are in nanoseconds
+ */
+struct operation_metrics {
+    // number of operations
+    u64 calls = 0;
+    // number of failed operations
+    u64 errors = 0;
+    // rows returned or affected
+    u64 rows = 0;
+    // bytes returned
+    u64 bytes = 0;
+    // durations
+    histogram latency;
+};
+
+/**
+ * Metrics of all threads at one point in time
+ */
+struct snapshot {
+    // metrics by operation::type
+    operation_metrics operations[operation::count];
+    // number of failed operations by error number
+    std::map<u32, u64> errors;
+};
+
+/**
+ * Starts recording metrics of connections, statements and result sets. Recording happens per
+ * thread without locks
+ */
+void enable();
+
+/**
+ * Stops recording, recorded metrics are kept
+ */
+void disable();
+
+/**
+ * Indicates whether metrics are recorded
+ */
+bool enabled();
+
+/**
+ * Collects the metrics recorded by all threads, including threads which ended
+ */
+snapshot get_snapshot();
+
+/**
+ * Clears all recorded metrics
+ */
+void reset();
+
+/**
+ * Gets the name of an operation as used in exported metrics
+ */
+const char *operation_name(operation::type op);
+
+/**
+ * Writes a snapshot in the Prometheus text exposition format. The le bounds of the duration
+ * histograms are the histogram bucket edges closest below common bounds from 100 us to 60 s, so
+ * their counts are exact. Output does not depend on the flags or locale of the stream.
+ *
+ * @param os Stream to write to
+ * @param s Snapshot to write
+ * @param prefix Prefix of all metric names
+ */
+void write_prometheus(std::ostream &os, const snapshot &s, const std::string &prefix = "mariadbpp");
+}  // namespace metrics
+}  // namespace mariadb
+
+#endif
@@ -0,0 +1,191 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_RESULT_CACHE_HPP_
+#define _MARIADB_RESULT_CACHE_HPP_
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <mariadb++/connection.hpp>
+
+namespace mariadb {
+class result_cache;
+typedef std::shared_ptr<result_cache> result_cache_ref;
+
+/**
+ * Opt-in, thread safe, in-process cache for query results.
+ *
+ * Results are keyed by their SQL and, for prepared statements, the bytes of the bound parameters,
+ * together with host, port, user, schema and charset of the connection. Changing the schema by
+ * executing USE is not tracked, use connection::set_schema() instead.
+ * A cached result is a detached copy which is served as regular result_set, independent of the
+ * connection it was read from. Entries expire after their time to live, are evicted in least
+ * recently used order once the memory cap is reached and can be invalidated by table tags.
+ */
+class result_cache {
+public:
+    typedef std::vector<std::string> tags_t;
+
+    // time to live argument selecting the default time to live of the cache
+    static const u32 default_ttl_ms = ~0u;
+
+    /**
+     * Destructs the cache and frees all entries. Result sets handed out stay valid
+     */
+    virtual ~result_cache() = default;
+
+    /**
+     * Executes a query on the connection unless a valid result for it is cached
+     *
+     * @param conn   Connection to execute the query on, on cache miss
+     * @param query  SQL query to execute
+     * @param tags   Tags (usually table names) to invalidate the result by
+     * @param ttl_ms Time to live of the result in milliseconds, zero means no expiry
+     * @return Result of the query as result_set
+     */
+    result_set_ref query(const connection_ref &conn, const std::string &query, const tags_t &tags = tags_t(),
+                         u32 ttl_ms = default_ttl_ms);
+
+    /**
+     * Executes a prepared statement with its currently bound parameters unless a valid result for
+     * them is cached
+     *
+     * @param stmt   Statement to execute, on cache miss
+     * @param tags   Tags (usually table names) to invalidate the result by
+     * @param ttl_ms Time to live of the result in milliseconds, zero means no expiry
+     * @return Result of the statement as result_set
+     */
+    result_set_ref query(const statement_ref &stmt, const tags_t &tags = tags_t(), u32 ttl_ms = default_ttl_ms);
+
+    /**
+     * Removes all entries tagged with tag
+     */
+    void invalidate(const std::string &tag);
+
+    /**
+     * Removes all entries
+     */
+    void clear();
+
+    /**
+     * Gets the number of cached results
+     */
+    u32 entry_count() const;
+
+    /**
+     * Gets the number of bytes used by cached results
+     */
+    u64 size() const;
+
+    /**
+     * Gets the maximum number of bytes used by cached results
+     */
+    u64 max_size() const;
+
+    /**
+     * Sets the maximum number of bytes used by cached results, evicts least recently used entries
+     * if needed
+     */
+    void set_max_size(u64 max_size);
+
+    /**
+     * Gets the default time to live of entries in milliseconds, zero means no expiry
+     */
+    u32 default_ttl() const;
+
+    /**
+     * Sets the default time to live of entries in milliseconds, zero means no expiry
+     */
+    void set_default_ttl(u32 ttl_ms);
+
+    /**
+     * Gets the number of queries served from the cache
+     */
+    u64 hits() const;
+
+    /**
+     * Gets the number of queries that had to be executed
+     */
+    u64 misses() const;
+
+    /**
+     * Creates a new result cache
+     *
+     * @param max_size    Maximum number of bytes used by cached results
+     * @param default_ttl Default time to live of entries in milliseconds, zero means no expiry
+     * @return Reference to the newly created cache
+     */
+    static result_cache_ref create(u64 max_size = 64 * 1024 * 1024, u32 default_ttl = 1000);
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    /**
+     * A single cached result
+     */
+    struct entry {
+        // key of this entry
+        std::string m_key;
+        // tags to invalidate this entry by
+        tags_t m_tags;
+        // the cached result
+        result_store_ref m_store;
+        // number of bytes accounted for this entry
+        u64 m_size;
+        // point in time the entry expires, if m_expires is set
+        clock::time_point m_expiry;
+        // indicates whether the entry expires at all
+        bool m_expires;
+    };
+
+    typedef std::list<entry> lru_t;
+
+    /**
+     * Private constructor used by create
+     */
+    result_cache(u64 max_size, u32 default_ttl);
+
+    /**
+     * Looks up a valid entry and marks it as most recently used
+     */
+    result_set_ref lookup(const std::string &key);
+
+    /**
+     * Detaches the result and stores it, returns a result_set reading from the stored copy
+     */
+    result_set_ref store(const std::string &key, const result_set_ref &rs, const tags_t &tags, u32 ttl_ms);
+
+    /**
+     * Removes an entry. Requires m_mutex to be held
+     */
+    void erase(lru_t::iterator it);
+
+    // protects all members below
+    mutable std::mutex m_mutex;
+    // entries, most recently used first
+    lru_t m_lru;
+    // entries by key
+    std::unordered_map<std::string, lru_t::iterator> m_entries;
+    // entries by tag
+    std::unordered_multimap<std::string, lru_t::iterator> m_tags;
+
+    // bytes used by entries
+    u64 m_size;
+    // maximum bytes used by entries
+    u64 m_max_size;
+    // default time to live in milliseconds
+    u32 m_default_ttl;
+    // statistics
+    u64 m_hits;
+    u64 m_misses;
+};
+}  // namespace mariadb
+
+#endif
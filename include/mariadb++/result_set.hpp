@@ -13,19 +13,25 @@
 
 #include <map>
 #include <vector>
+#include <string.h>
 #include <mariadb++/bind.hpp>
 #include <mariadb++/data.hpp>
 #include <mariadb++/date_time.hpp>
 #include <mariadb++/decimal.hpp>
+#include <mariadb++/expected.hpp>
 #include <mariadb++/last_error.hpp>
 
 #define MAKE_GETTER_SIG_STR(nm, rtype, fq) rtype fq get_##nm(const std::string &name) const
 #define MAKE_GETTER_SIG_NUM(nm, rtype, fq) rtype fq get_##nm(u32 index) const
 #define MAKE_GETTER_SIG_INT(nm, rtype, fq) rtype fq _get_body_##nm(u32 index) const
-
-#define MAKE_GETTER_DECL(nm, rtype)   \
-    MAKE_GETTER_SIG_STR(nm, rtype, ); \
-    MAKE_GETTER_SIG_NUM(nm, rtype, ); \
+#define MAKE_TRY_GETTER_SIG_STR(nm, rtype, fq) expected<rtype> fq try_get_##nm(const std::string &name) const
+#define MAKE_TRY_GETTER_SIG_NUM(nm, rtype, fq) expected<rtype> fq try_get_##nm(u32 index) const
+
+#define MAKE_GETTER_DECL(nm, rtype)       \
+    MAKE_GETTER_SIG_STR(nm, rtype, );     \
+    MAKE_GETTER_SIG_NUM(nm, rtype, );     \
+    MAKE_TRY_GETTER_SIG_STR(nm, rtype, ); \
+    MAKE_TRY_GETTER_SIG_NUM(nm, rtype, ); \
     MAKE_GETTER_SIG_INT(nm, rtype, )
 
 #define MAKE_GETTER(nm, rtype, vtype)                             \
@@ -41,11 +47,23 @@
                                                                   \
         return _get_body_##nm(index);                             \
     }                                                             \
+    MAKE_TRY_GETTER_SIG_STR(nm, rtype, result_set::) {            \
+        return try_get_##nm(column_index(name));                  \
+    }                                                             \
+    MAKE_TRY_GETTER_SIG_NUM(nm, rtype, result_set::) {            \
+        error_info error;                                         \
+        if (!check_column(index, vtype, error))                   \
+            return error;                                         \
+                                                                  \
+        return _get_body_##nm(index);                             \
+    }                                                             \
     MAKE_GETTER_SIG_INT(nm, rtype, result_set::)
 
 namespace mariadb {
 class connection;
 class statement;
+class result_set;
+typedef std::shared_ptr<result_set> result_set_ref;
 
 /*
  * This data is shared between a statement and its result_set,
@@ -56,7 +74,7 @@ class statement;
  * A shared_ptr is used to keep the data alive in the statement and the result_set.
  */
 struct statement_data {
-    explicit statement_data(MYSQL_STMT *stmt) : m_statement(stmt) {}
+    statement_data(MYSQL_STMT *stmt, const std::string &query) : m_statement(stmt), m_query(query) {}
 
     ~statement_data();
 
@@ -64,6 +82,8 @@ struct statement_data {
     unsigned long m_bind_count = 0;
     // pointer to underlying statement
     MYSQL_STMT *m_statement;
+    // query the statement was prepared with
+    std::string m_query;
     // pointer to raw binds
     MYSQL_BIND *m_raw_binds = nullptr;
     // pointer to managed binds
@@ -72,12 +92,18 @@ struct statement_data {
 
 typedef std::shared_ptr<statement_data> statement_data_ref;
 
+// detached copy of a result, internal to the library
+struct result_store;
+typedef std::shared_ptr<const result_store> result_store_ref;
+
 /**
  * Class used to store query and statement results
  */
 class result_set : public last_error {
     friend class connection;
     friend class statement;
+    friend class result_cache;
+    friend struct result_store;
 
     typedef std::map<std::string, u32> map_indexes_t;
 
@@ -156,12 +182,33 @@ public:
      */
     bool set_row_index(u64 index);
 
-    // declare all getters
+    /**
+     * Copies all remaining rows, starting with the current one if a row was fetched, into a
+     * self-contained result_set. The copy keeps all cells in a single arena and does not depend on
+     * the connection or statement anymore, which can be reused right away. Consumes this
+     * result_set, unless it is detached itself and no row was fetched yet: then the rows are
+     * shared and the call is cheap, which allows handing out one cursor per thread.
+     *
+     * @return Detached result_set positioned before its first row
+     */
+    result_set_ref materialize();
+
+    /**
+     * Indicates whether this result_set was materialized and is independent of any connection
+     *
+     * @return True if detached
+     */
+    bool is_detached() const;
+
+    // declare all getters. The try_get_* variants return a missing row, unknown column or type
+    // mismatch as error instead of throwing
     MAKE_GETTER_DECL(blob, stream_ref);
     MAKE_GETTER_DECL(data, data_ref);
     MAKE_GETTER_DECL(date, date_time);
     MAKE_GETTER_DECL(date_time, date_time);
     MAKE_GETTER_DECL(time, time);
+    MAKE_GETTER_DECL(time_point, std::chrono::system_clock::time_point);
+    MAKE_GETTER_DECL(duration, std::chrono::microseconds);
     MAKE_GETTER_DECL(decimal, decimal);
     MAKE_GETTER_DECL(string, std::string);
     MAKE_GETTER_DECL(boolean, bool);
@@ -179,20 +226,54 @@ public:
 
 private:
     /**
-     * Create result_set from connection
+     * Create result_set from the stored or used result of a connection
      */
-    explicit result_set(connection *conn);
+    explicit result_set(MYSQL_RES *result);
 
     /**
-     * Create result_set from statement
+     * Create result_set from statement, its result is already stored if buffered
      */
     explicit result_set(connection *conn, const statement_data_ref &stmt);
 
     /**
-     * Resizes bind buffers for truncated columns after a failed fetch and fetches them again
+     * Create result_set reading from a detached store
+     */
+    explicit result_set(const result_store_ref &store);
+
+    /**
+     * Copies all rows starting with the current one (if any was fetched) into a detached store.
+     * Consumes this result_set, unless it reads from a store and no row was fetched yet.
+     */
+    result_store_ref make_store();
+
+    /**
+     * Gets the number of bytes of the binary or text representation of the column at index
+     */
+    unsigned long cell_size(u32 index) const;
+
+    /**
+     * Reads the binary value of the column at index of the current row, as stored by prepared
+     * statements
+     */
+    template <typename T>
+    T binary_value(u32 index) const {
+        T value = T();
+        if (m_row[index])
+            memcpy(&value, m_row[index], sizeof(T));
+        return value;
+    }
+
+    /**
+     * Resizes bind buffers for truncated columns after a failed fetch, fetches them again and binds the
+     * grown buffers for the following rows
      */
     bool fetch_truncated();
 
+    /**
+     * Fetches the complete value of a column left truncated because of the stream threshold
+     */
+    void load_column(u32 index) const;
+
     /**
      * Throws if the result set was created, but no row was ever fetched (using next())
      */
@@ -206,15 +287,28 @@ private:
      */
     void check_type(u32 index, value::type requested) const;
 
+    /**
+     * Checks that a row was fetched, the column exists and can be converted to the requested type
+     * without throwing, used by the try_get_* getters
+     *
+     * @param index Index of column to check
+     * @param requested Requested type
+     * @param error Filled if the check fails
+     * @return True if the column can be read
+     */
+    bool check_column(u32 index, value::type requested, error_info &error) const;
+
     // pointer to result set
     MYSQL_RES *m_result_set;
     // pointer to array of fields
-    MYSQL_FIELD *m_fields;
+    const MYSQL_FIELD *m_fields;
     // pointer to current row
     MYSQL_ROW m_row;
     // pointer to raw binds
     MYSQL_BIND *m_raw_binds;
 
+    // buffers of variable sized columns of statement results
+    arena m_buffers;
     // vector of managed binds
     std::vector<bind_ref> m_binds;
     // optional pointer to statement
@@ -224,13 +318,24 @@ private:
     // array of content lengths for the columns of current row
     long unsigned int *m_lengths;
 
+    // optional detached store
+    result_store_ref m_store;
+    // index of the next row to fetch from the store
+    u64 m_store_row;
+    // pointers to the cells of the current row of the store
+    std::vector<char *> m_store_cells;
+    // lengths of the cells of the current row of the store
+    std::vector<unsigned long> m_store_lengths;
+
     // count of fields per row
     u32 m_field_count;
     // indicates if a row was fetched using next()
     bool m_was_fetched;
+    // indicates if cells hold binary values as bound by prepared statements
+    bool m_binary;
+    // size in bytes above which columns are not buffered when fetching a row
+    u64 m_stream_threshold;
 };
-
-typedef std::shared_ptr<result_set> result_set_ref;
 }  // namespace mariadb
 
 #endif
@@ -0,0 +1,84 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_SLOW_LOG_HPP_
+#define _MARIADB_SLOW_LOG_HPP_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <mariadb++/types.hpp>
+
+namespace mariadb {
+namespace slow_log {
+/**
+ * Aggregate of all slow executions of one normalized SQL text. Times are in nanoseconds
+ */
+struct entry {
+    // fingerprint of the normalized SQL, see tracing::fingerprint()
+    u64 fingerprint = 0;
+    // normalized SQL, literals replaced by ?
+    std::string sql;
+    // number of slow executions
+    u64 count = 0;
+    // number of slow executions which failed
+    u64 errors = 0;
+    // rows returned or affected, as seen by the client. Rows of unbuffered results are fetched
+    // after the call and not counted
+    u64 rows = 0;
+    // total and longest execution time
+    u64 total_time = 0;
+    u64 max_time = 0;
+};
+
+/**
+ * Starts recording queries and prepared statement executions of all connections which take at
+ * least threshold_ms. Executions are aggregated by the fingerprint of their normalized SQL, only
+ * SQL of slow executions is normalized. Once capacity fingerprints are kept, a new one replaces
+ * the one with the least total time if it took longer than that.
+ *
+ * Calling enable() again changes threshold and capacity, recorded entries are kept.
+ *
+ * @param threshold_ms Minimum execution time in milliseconds, 0 records every execution
+ * @param capacity Maximum number of fingerprints kept
+ */
+void enable(u64 threshold_ms = 100, u32 capacity = 100);
+
+/**
+ * Stops recording, recorded entries are kept
+ */
+void disable();
+
+/**
+ * Indicates whether slow queries are recorded
+ */
+bool enabled();
+
+/**
+ * Gets the recorded entries ordered by total time, longest first
+ *
+ * @param limit Maximum number of entries, 0 for all
+ */
+std::vector<entry> get_top(u32 limit = 0);
+
+/**
+ * Clears all recorded entries
+ */
+void reset();
+
+/**
+ * Writes the recorded entries ordered by total time as text, one line per entry
+ *
+ * @param os Stream to write to
+ * @param limit Maximum number of entries, 0 for all
+ */
+void dump(std::ostream &os, u32 limit = 0);
+}  // namespace slow_log
+}  // namespace mariadb
+
+#endif
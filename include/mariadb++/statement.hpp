@@ -11,6 +11,7 @@
 #ifndef _MARIADB_STATEMENT_HPP_
 #define _MARIADB_STATEMENT_HPP_
 
+#include <mariadb++/expected.hpp>
 #include <mariadb++/last_error.hpp>
 #include <mariadb++/result_set.hpp>
 
@@ -43,6 +44,7 @@ typedef std::shared_ptr<connection> connection_ref;
 class statement : public last_error {
     friend class connection;
     friend class result_set;
+    friend class result_cache;
     friend class worker;
 
 public:
@@ -69,6 +71,17 @@ public:
      */
     result_set_ref query();
 
+    /**
+     * Non-throwing variants of execute(), insert() and query() for failures which are expected,
+     * such as duplicate keys or lock wait timeouts. Errors of the statement, including storing its
+     * result, are returned instead of thrown. Like thrown errors, they are passed to the error log.
+     *
+     * @return Result of the call or the error of the statement
+     */
+    expected<u64> try_execute();
+    expected<u64> try_insert();
+    expected<result_set_ref> try_query();
+
     /**
      * Set connection ref, used by concurrency
      */
@@ -79,6 +92,8 @@ public:
     MAKE_SETTER_DECL(date_time, const date_time &);
     MAKE_SETTER_DECL(date, const date_time &);
     MAKE_SETTER_DECL(time, const time &);
+    MAKE_SETTER_DECL(time_point, const std::chrono::system_clock::time_point &);
+    MAKE_SETTER_DECL(duration, const std::chrono::microseconds &);
     MAKE_SETTER_DECL(data, const data_ref &);
     MAKE_SETTER_DECL(decimal, const decimal &);
     MAKE_SETTER_DECL(string, const std::string &);
@@ -101,6 +116,21 @@ private:
      */
     statement(connection *conn, const std::string &query);
 
+    /**
+     * Builds a key identifying the query together with the currently bound parameters and the
+     * server, user and schema of the connection. It never equals the key of the same SQL run as
+     * text query, whose results are encoded differently
+     */
+    std::string cache_key() const;
+
+    /**
+     * Implementation of the throwing and non-throwing calls: fills error and returns false on
+     * failure if error is given, throws otherwise
+     */
+    bool run_execute(u64 &affected_rows, error_info *error);
+    bool run_insert(u64 &id, error_info *error);
+    bool run_query(result_set_ref &result, error_info *error);
+
     // reference to parent connection
     connection_ref m_connection;
     // non-owning pointer to parent connection
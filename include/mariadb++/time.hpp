@@ -11,6 +11,7 @@
 #ifndef _MARIADB_TIME_HPP_
 #define _MARIADB_TIME_HPP_
 
+#include <chrono>
 #include <iostream>
 #include <mariadb++/time_span.hpp>
 
@@ -47,19 +48,26 @@ public:
     time(const tm &time_struct);
 
     /**
-     * Construct time from time.h functions
+     * Construct time from time_t, taken as UTC. Does not depend on the timezone
      *
-     * @param time Timestruct to copy from
+     * @param time Seconds since the epoch
      */
     time(const time_t &time);
 
     /**
-     * Construct time from SQL time
+     * Construct time from SQL time, keeping microseconds
      *
      * @param time SQL time to copy from
      */
     time(const MYSQL_TIME &time);
 
+    /**
+     * Construct time from a duration since midnight, wrapping around at midnight like add_* does
+     *
+     * @param time_of_day Duration since midnight
+     */
+    explicit time(const std::chrono::microseconds &time_of_day);
+
     /**
      * Construct time from string
      * The format needs to be hh[:mm][:ss][:nnn]
@@ -153,14 +161,25 @@ public:
     u16 millisecond() const;
 
     /**
-     * Set the current millisecond 0-999
+     * Set the current millisecond 0-999, clears microseconds
      */
     u16 millisecond(u16 millisecond);
 
+    /**
+     * Get the current microsecond 0-999999, this includes the milliseconds
+     */
+    u32 microsecond() const;
+
+    /**
+     * Set the current microsecond 0-999999, this includes the milliseconds
+     */
+    u32 microsecond(u32 microsecond);
+
     /**
      * Set the time from string
      * The format needs to be hh[:mm][:ss][.nnn]
-     * where less digits are possible and the delimiter may be any non digit
+     * where less digits are possible and the delimiter may be any non digit.
+     * A fraction of exactly six digits is read as microseconds, as sent by the server for TIME(6)
      *
      * Examples:
      * h
@@ -215,6 +234,14 @@ public:
      */
     time add_milliseconds(s32 milliseconds) const;
 
+    /**
+     * Adds a duration to the current time. Negative values subtract
+     *
+     * @param dur Duration to add
+     * @return Time containing sum
+     */
+    time add(const std::chrono::microseconds &dur) const;
+
     /**
      * Subtracts the given timespan from the current time
      *
@@ -240,15 +267,14 @@ public:
     time_span time_between(const time &t) const;
 
     /**
-     * Converts the time to time_t (time.h representation)
+     * Converts the time to time_t, as seconds since midnight of 1970-01-01 UTC
      *
      * @return Time as time.h time_t
      */
     time_t mktime() const;
 
     /**
-     * Calculates the time difference using ::difftime.
-     * Calculates (this - t)
+     * Calculates the time difference (this - t)
      *
      * @return Difference in seconds as double
      */
@@ -273,10 +299,9 @@ public:
     static bool valid_time(u8 hour, u8 minute, u8 second, u16 millisecond);
 
     /**
-     * Converts the time to MySQL time representation. Note that MySQL time does not support
-     * milliseconds
+     * Converts the time to MySQL time representation
      *
-     * @return Time as MYSQL_TIME with no milliseconds
+     * @return Time as MYSQL_TIME including microseconds
      */
     MYSQL_TIME mysql_time() const;
 
@@ -290,24 +315,54 @@ public:
     const std::string str_time(bool with_millisecond = false) const;
 
     /**
-     * Uses time.h to determine the current time in the local timezone.
+     * Uses time.h to determine the current time in the local timezone. This takes the timezone
+     * lock of the C library, prefer now_utc() where possible
      *
      * @return Time representing now
      */
     static time now();
 
     /**
-     * Uses time.h to determine the current time in UTC timezone.
+     * Determines the current time in UTC from the realtime clock, without consulting the timezone
      *
      * @return Time representing now in UTC
      */
     static time now_utc();
 
+    /**
+     * Converts a time_t to the local timezone using time.h. This takes the timezone lock of the C
+     * library
+     *
+     * @param time Seconds since the epoch
+     * @return Time of day in the local timezone
+     */
+    static time from_local_time(const time_t &time);
+
+    /**
+     * Gets the time of day as duration since midnight
+     *
+     * @return Microseconds since midnight
+     */
+    std::chrono::microseconds time_of_day() const;
+
+    /**
+     * Sets the time of day from a duration since midnight, wrapping around at midnight
+     *
+     * @param time_of_day Duration since midnight
+     * @return Newly set duration since midnight
+     */
+    std::chrono::microseconds time_of_day(const std::chrono::microseconds &time_of_day);
+
 protected:
+    /**
+     * Sets the time from a number of microseconds since midnight, which must be less than a day
+     */
+    void set_time_of_day(s64 us);
+
     u8 m_hour;
     u8 m_minute;
     u8 m_second;
-    u16 m_millisecond;
+    u32 m_microsecond;
 };
 
 std::ostream &operator<<(std::ostream &os, const time &t);
@@ -0,0 +1,127 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_TRACING_HPP_
+#define _MARIADB_TRACING_HPP_
+
+#include <string>
+#include <mariadb++/types.hpp>
+
+namespace mariadb {
+namespace tracing {
+/**
+ * One traced round-trip or client side step. Times are nanoseconds of the steady clock
+ */
+struct span {
+    // kind of operation
+    operation::type operation;
+    // SQL text, not null terminated, nullptr if the operation has none
+    const char *sql;
+    size_t sql_length;
+    // start time
+    u64 start;
+    // duration, 0 until the operation ended
+    u64 duration;
+    // error number of a failed operation, 0 on success
+    u32 error;
+    // rows returned or affected
+    u64 rows;
+    // bytes returned
+    u64 bytes;
+
+    /**
+     * Gets the SQL text with literals replaced, see normalize()
+     */
+    std::string normalized() const;
+
+    /**
+     * Gets the fingerprint of the SQL text, see fingerprint()
+     */
+    u64 fingerprint() const;
+};
+
+/**
+ * Receives spans of connections, statements, result sets, pools and concurrency workers.
+ * Callbacks run on the thread doing the work, synchronously, so they should be quick. They must
+ * not throw and must not use the connection the span belongs to.
+ *
+ * Operations of the text protocol (query, execute, insert) report start and end, all others
+ * report once they ended.
+ */
+class observer {
+public:
+    virtual ~observer() = default;
+
+    /**
+     * A text protocol query was sent, the span has no duration yet
+     */
+    virtual void on_query_start(const span &) {}
+
+    /**
+     * A text protocol query returned, for query() including the transfer of a stored result
+     */
+    virtual void on_query_end(const span &) {}
+
+    /**
+     * A statement was prepared
+     */
+    virtual void on_prepare(const span &) {}
+
+    /**
+     * A prepared statement was executed, for query() including the transfer of a stored result
+     */
+    virtual void on_execute(const span &) {}
+
+    /**
+     * Rows were fetched by result_set::next(), from the network or from a stored result
+     */
+    virtual void on_fetch_batch(const span &) {}
+
+    /**
+     * A connection was established
+     */
+    virtual void on_connect(const span &) {}
+
+    /**
+     * A connection was leased from a pool, the duration is the time spent waiting for it
+     */
+    virtual void on_pool_wait(const span &) {}
+};
+
+/**
+ * Installs an observer. Observers stay owned by the caller and must outlive their installation.
+ * While none is installed tracing costs a single load and branch per operation.
+ */
+void add_observer(observer *o);
+
+/**
+ * Uninstalls an observer. Operations running concurrently may still report to it
+ */
+void remove_observer(observer *o);
+
+/**
+ * Normalizes SQL text: literals are replaced by ?, lists of literals collapse into a single ?,
+ * comments are dropped and whitespace is collapsed. Queries differing only in their values
+ * normalize to the same text.
+ *
+ * @param sql SQL text
+ * @param length Length of the text
+ * @return Normalized text
+ */
+std::string normalize(const char *sql, size_t length);
+std::string normalize(const std::string &sql);
+
+/**
+ * Gets a 64 bit hash of the normalized SQL text
+ */
+u64 fingerprint(const char *sql, size_t length);
+u64 fingerprint(const std::string &sql);
+}  // namespace tracing
+}  // namespace mariadb
+
+#endif
@@ -19,6 +19,24 @@ namespace mariadb {
 class connection;
 class save_point;
 
+/**
+ * Controls how connection::run_in_transaction() retries transactions aborted by the server
+ */
+struct retry_policy {
+    // maximum number of attempts, including the first one
+    u32 max_attempts = 5;
+    // upper bound of the delay before the first retry in milliseconds, doubled on every further retry
+    u32 base_delay_ms = 10;
+    // upper bound of any delay in milliseconds
+    u32 max_delay_ms = 1000;
+    // indicates whether lock wait timeouts (1205) are retried in addition to deadlocks (1213)
+    bool retry_lock_wait_timeout = true;
+    // settings of each attempt, see connection::create_transaction()
+    isolation::level level = isolation::repeatable_read;
+    bool consistent_snapshot = true;
+    bool read_only = false;
+};
+
 /**
  * Class representing a SQL transaction having automatic rollback functionality
  */
@@ -33,7 +51,8 @@ public:
     virtual ~transaction();
 
     /**
-     * Commits the changes, releases all savepoints
+     * Commits the changes, releases all savepoints. Throws exception::connection if the server
+     * refuses the commit, the transaction is rolled back on destruction in that case
      */
     void commit();
 
@@ -53,8 +72,9 @@ private:
      * @param level                 Level of database isolation to use
      * @param consistent_snapshot   Controls whether the transaction needs a consistent snapshot on
      * creation
+     * @param read_only             Controls whether the transaction is started READ ONLY
      */
-    transaction(connection *conn, isolation::level level, bool consistent_snapshot);
+    transaction(connection *conn, isolation::level level, bool consistent_snapshot, bool read_only);
 
     /**
      * Removes a savepoint from the list of savepoints
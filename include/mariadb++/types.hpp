@@ -72,6 +72,25 @@ namespace isolation {
 enum level { repeatable_read = 0, read_committed, read_uncommitted, serializable };
 }
 
+//
+// Instrumented operation
+//
+namespace operation {
+enum type {
+    connect = 0,
+    query,
+    execute,
+    insert,
+    prepare,
+    statement_query,
+    statement_execute,
+    statement_insert,
+    fetch,
+    pool_wait,
+    count
+};
+}
+
 //
 // Stream
 //
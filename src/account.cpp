@@ -96,6 +96,14 @@ void account::set_store_result(bool store_result) {
     m_store_result = store_result;
 }
 
+u64 account::stream_threshold() const {
+    return m_stream_threshold;
+}
+
+void account::set_stream_threshold(u64 threshold) {
+    m_stream_threshold = threshold;
+}
+
 const account::map_options_t &account::options() const {
     return m_options;
 }
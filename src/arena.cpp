@@ -0,0 +1,61 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstdint>
+#include <mariadb++/arena.hpp>
+
+using namespace mariadb;
+
+namespace {
+//
+// Gets the number of bytes to skip from position to reach alignment
+//
+size_t padding(const char *position, size_t alignment) {
+    return (alignment - reinterpret_cast<uintptr_t>(position) % alignment) % alignment;
+}
+}  // namespace
+
+arena::arena(size_t block_size)
+    : m_free(nullptr), m_left(0), m_next_size(std::max<size_t>(block_size, 1)), m_capacity(0) {}
+
+void arena::reserve(size_t size) {
+    if (!m_free || size > m_left)
+        grow(size);
+}
+
+void *arena::allocate(size_t size, size_t alignment) {
+    size_t skip = m_free ? padding(m_free, alignment) : 0;
+    if (!m_free || size + skip > m_left) {
+        // a new block may start anywhere, so it has room for the worst case padding
+        grow(size + alignment - 1);
+        skip = padding(m_free, alignment);
+    }
+
+    char *result = m_free + skip;
+    m_free += skip + size;
+    m_left -= skip + size;
+    return result;
+}
+
+void arena::deallocate(void *, size_t) {}
+
+size_t arena::capacity() const {
+    return m_capacity;
+}
+
+void arena::grow(size_t size) {
+    // the rest of the current block is abandoned
+    const size_t block_size = std::max(size, m_next_size);
+
+    m_blocks.emplace_back(new char[block_size]);
+    m_free = m_blocks.back().get();
+    m_left = block_size;
+    m_capacity += block_size;
+    m_next_size = block_size * 2;
+}
@@ -10,11 +10,12 @@
 
 #include <mysql.h>
 #include <memory.h>
+#include <algorithm>
 #include <mariadb++/bind.hpp>
 
 using namespace mariadb;
 
-bind::bind(MYSQL_BIND *b) : m_bind(b), m_is_null(0), m_error(0) {
+bind::bind(MYSQL_BIND *b) : m_bind(b), m_is_null(0), m_error(0), m_deferred(false), m_arena(nullptr), m_length(0) {
     // clear bind
     memset(b, 0, sizeof(MYSQL_BIND));
 
@@ -27,38 +28,47 @@ bind::bind(MYSQL_BIND *b) : m_bind(b), m_is_null(0), m_error(0) {
     m_bind->length = &m_bind->buffer_length;
 }
 
-bind::bind(MYSQL_BIND *b, MYSQL_FIELD *f) : bind(b) {
-    set(f->type, nullptr, f->max_length, (f->flags & UNSIGNED_FLAG) == UNSIGNED_FLAG);
+bind::bind(MYSQL_BIND *b, const MYSQL_FIELD *f, arena &buffers, unsigned long length) : bind(b) {
+    // results report their length separately, so the buffer length keeps the capacity
+    m_arena = &buffers;
+    m_bind->length = &m_length;
+
+    set(f->type, nullptr, length, (f->flags & UNSIGNED_FLAG) == UNSIGNED_FLAG);
 }
 
 char *bind::buffer() const {
-    if (m_data)
-        return m_data->get();
-
-    return const_cast<char *>(reinterpret_cast<const char *>(&m_unsigned64));
+    return static_cast<char *>(m_bind->buffer);
 }
 
 unsigned long bind::length() const {
-    return m_bind->buffer_length;
+    return *m_bind->length;
 }
 
 bool bind::is_null() const {
     return (m_is_null != 0);
 }
 
+bool bind::is_truncated() const {
+    return m_arena && m_length > m_bind->buffer_length && m_bind->buffer != &m_unsigned64 &&
+           m_bind->buffer != &m_time;
+}
+
 bool bind::resize() {
-    if (m_data && m_data->size() < m_bind->buffer_length) {
-        if (!m_data->resize(m_bind->buffer_length))
-            return false;
-        m_bind->buffer = m_data->get();
-        m_bind->buffer_length = m_data->size();
-    }
+    if (!is_truncated())
+        return true;
+
+    // grow geometrically, the previous buffer stays in the arena until the result is freed
+    const unsigned long capacity = std::max(m_length, 2 * m_bind->buffer_length);
+    m_bind->buffer = m_arena->allocate(capacity);
+    m_bind->buffer_length = capacity;
     return true;
 }
 
 void bind::set(enum_field_types type, const char *buffer, unsigned long length, bool us) {
     m_bind->buffer_type = type;
     m_bind->is_unsigned = us ? 1 : 0;
+    // fixed size types live in the union, a previous type may have redirected the buffer
+    m_bind->buffer = &m_unsigned64;
 
     switch (type) {
         case MYSQL_TYPE_NULL:
@@ -112,9 +122,14 @@ void bind::set(enum_field_types type, const char *buffer, unsigned long length,
         case MYSQL_TYPE_VARCHAR:
         case MYSQL_TYPE_VAR_STRING:
         case MYSQL_TYPE_STRING:
-            m_data = data_ref(new data<char>(length));
-            m_bind->buffer = m_data->get();
-            m_bind->buffer_length = m_data->size();
+            if (m_arena) {
+                m_bind->buffer = m_arena->allocate(length);
+                m_bind->buffer_length = length;
+            } else {
+                m_data.create(length);
+                m_bind->buffer = m_data.get();
+                m_bind->buffer_length = m_data.size();
+            }
 
             if (buffer)
                 memcpy(m_bind->buffer, buffer, length);
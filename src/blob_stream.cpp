@@ -0,0 +1,130 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mysql.h>
+#include <string.h>
+#include <algorithm>
+#include <mariadb++/blob_stream.hpp>
+
+using namespace mariadb;
+
+namespace {
+//
+// Resolves a seek request to an absolute position, returns -1 if out of range
+//
+std::streamoff absolute_position(std::streamoff offset, std::ios_base::seekdir dir, std::streamoff current,
+                                 std::streamoff size) {
+    std::streamoff pos;
+
+    if (dir == std::ios_base::beg)
+        pos = offset;
+    else if (dir == std::ios_base::cur)
+        pos = current + offset;
+    else
+        pos = size + offset;
+
+    return pos < 0 || pos > size ? -1 : pos;
+}
+}  // namespace
+
+memory_streambuf::memory_streambuf(const char *data, size_t size, const std::shared_ptr<const void> &owner)
+    : m_owner(owner) {
+    // the get area is never written to
+    char *begin = const_cast<char *>(data);
+    setg(begin, begin, begin + size);
+}
+
+memory_streambuf::pos_type memory_streambuf::seekoff(off_type offset, std::ios_base::seekdir dir,
+                                                     std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in))
+        return pos_type(off_type(-1));
+
+    const std::streamoff pos = absolute_position(offset, dir, gptr() - eback(), egptr() - eback());
+    if (pos >= 0)
+        setg(eback(), eback() + pos, egptr());
+
+    return pos_type(pos);
+}
+
+memory_streambuf::pos_type memory_streambuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+column_streambuf::column_streambuf(const statement_data_ref &stmt, u32 column, enum_field_types type, u64 size,
+                                   size_t chunk_size)
+    : m_stmt(stmt),
+      m_column(column),
+      m_type(type),
+      m_size(size),
+      m_offset(0),
+      m_chunk(static_cast<size_t>(std::max<u64>(1, std::min<u64>(chunk_size, size)))) {
+    setg(m_chunk.data(), m_chunk.data(), m_chunk.data());
+}
+
+u64 column_streambuf::position() const {
+    return m_offset + static_cast<u64>(gptr() - eback());
+}
+
+column_streambuf::int_type column_streambuf::underflow() {
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    const u64 offset = position();
+    if (offset >= m_size)
+        return traits_type::eof();
+
+    unsigned long length = 0;
+    my_bool is_null = 0, error = 0;
+
+    MYSQL_BIND chunk;
+    memset(&chunk, 0, sizeof(MYSQL_BIND));
+    chunk.buffer_type = m_type;
+    chunk.buffer = m_chunk.data();
+    chunk.buffer_length = static_cast<unsigned long>(std::min<u64>(m_chunk.size(), m_size - offset));
+    chunk.length = &length;
+    chunk.is_null = &is_null;
+    chunk.error = &error;
+
+    if (mysql_stmt_fetch_column(m_stmt->m_statement, &chunk, m_column, static_cast<unsigned long>(offset)))
+        return traits_type::eof();
+
+    m_offset = offset;
+    setg(m_chunk.data(), m_chunk.data(), m_chunk.data() + chunk.buffer_length);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize column_streambuf::showmanyc() {
+    const u64 offset = position();
+    return offset < m_size ? static_cast<std::streamsize>(m_size - offset) : -1;
+}
+
+column_streambuf::pos_type column_streambuf::seekoff(off_type offset, std::ios_base::seekdir dir,
+                                                     std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in))
+        return pos_type(off_type(-1));
+
+    const std::streamoff pos = absolute_position(offset, dir, static_cast<std::streamoff>(position()),
+                                                 static_cast<std::streamoff>(m_size));
+    if (pos < 0)
+        return pos_type(pos);
+
+    // stay within the current chunk if possible, otherwise the next read fetches from pos
+    const u64 target = static_cast<u64>(pos);
+    if (target >= m_offset && target <= m_offset + static_cast<u64>(egptr() - eback()))
+        setg(eback(), eback() + (target - m_offset), egptr());
+    else {
+        m_offset = target;
+        setg(m_chunk.data(), m_chunk.data(), m_chunk.data());
+    }
+
+    return pos_type(pos);
+}
+
+column_streambuf::pos_type column_streambuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
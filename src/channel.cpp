@@ -0,0 +1,310 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mysql.h>
+#include <mariadb++/exceptions.hpp>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "channel.hpp"
+#include "worker.hpp"
+
+using namespace mariadb;
+using namespace mariadb::concurrency;
+
+namespace {
+// maximum number of queued workers per channel, 0 if unbounded
+std::atomic<u32> g_capacity(0);
+// what to do when a queue is full
+std::atomic<overflow::policy> g_policy(overflow::block);
+// time a worker may wait in a queue before it is skipped, 0 if unlimited
+std::atomic<u64> g_max_wait_ms(0);
+
+// queue metrics over all channels
+std::atomic<u64> g_depth(0);
+std::atomic<u64> g_peak_depth(0);
+std::atomic<u64> g_submitted(0);
+std::atomic<u64> g_rejected(0);
+std::atomic<u64> g_dropped(0);
+std::atomic<u64> g_expired(0);
+
+// all channels, to wake their producers when the limit changes. Never destroyed, the default
+// channel is destroyed during static destruction
+std::mutex &channels_lock() {
+    static std::mutex *lock = new std::mutex();
+    return *lock;
+}
+
+//
+// Account for a submitted worker before it becomes visible to the running thread
+//
+void queued() {
+    g_submitted.fetch_add(1);
+    u64 depth = g_depth.fetch_add(1) + 1;
+    u64 peak = g_peak_depth.load();
+    while (depth > peak && !g_peak_depth.compare_exchange_weak(peak, depth)) {
+    }
+}
+
+std::set<channel *> &channels() {
+    static std::set<channel *> *instances = new std::set<channel *>();
+    return *instances;
+}
+}  // namespace
+
+//
+// Queue limits
+//
+void concurrency::set_queue_limit(u32 capacity, overflow::policy policy, u64 max_wait_ms) {
+    g_policy = policy;
+    g_max_wait_ms = max_wait_ms;
+    g_capacity = capacity;
+
+    // producers blocked on a full queue check the new limit
+    channel::notify_limit_changed();
+}
+
+queue_metrics concurrency::get_queue_metrics() {
+    queue_metrics metrics;
+    metrics.depth = g_depth.load();
+    metrics.peak_depth = g_peak_depth.load();
+    metrics.submitted = g_submitted.load();
+    metrics.rejected = g_rejected.load();
+    metrics.dropped = g_dropped.load();
+    metrics.expired = g_expired.load();
+    return metrics;
+}
+
+channel::channel(const connection_pool_ref &session_pool)
+    : m_inbox(nullptr),
+      m_head(nullptr),
+      m_tail(nullptr),
+      m_bounded(0),
+      m_depth(0),
+      m_waiting(0),
+      m_running(false),
+      m_session_pool(session_pool) {
+    std::lock_guard<std::mutex> lock(channels_lock());
+    channels().insert(this);
+}
+
+channel::~channel() {
+    std::lock_guard<std::mutex> lock(channels_lock());
+    channels().erase(this);
+}
+
+void channel::notify_limit_changed() {
+    std::lock_guard<std::mutex> lock(channels_lock());
+
+    for (channel *c : channels()) {
+        // taking the queue lock makes sure a producer either sees the new limit or is waiting
+        std::lock_guard<std::mutex> queue_lock(c->m_lock);
+        c->m_space.notify_all();
+    }
+}
+
+void channel::submit(worker *w) {
+    const u64 max_wait_ms = g_max_wait_ms.load();
+    if (max_wait_ms)
+        w->deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(max_wait_ms));
+
+    worker *dropped = nullptr;
+
+    if (!g_capacity.load()) {
+        // unbounded, push onto the inbox without taking the lock
+        queued();
+        m_depth.fetch_add(1);
+
+        worker *head = m_inbox.load(std::memory_order_relaxed);
+        do {
+            w->next(head);
+        } while (!m_inbox.compare_exchange_weak(head, w));
+    } else {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        // workers pushed while unbounded go first
+        splice(m_inbox.exchange(nullptr));
+
+        u32 capacity = g_capacity.load();
+        if (capacity && m_depth.load() >= capacity) {
+            switch (g_policy.load()) {
+                case overflow::drop_oldest:
+                    dropped = pop();
+                    if (dropped)
+                        break;
+
+                    // the queued workers were already taken by the running thread when the limit
+                    // was set and cannot be dropped anymore, wait for them to leave the queue
+                    // fall through
+
+                case overflow::block:
+                    // the limit may be lifted while waiting
+                    m_waiting.fetch_add(1);
+                    while (capacity && m_depth.load() >= capacity) {
+                        m_space.wait(lock);
+                        capacity = g_capacity.load();
+                    }
+                    m_waiting.fetch_sub(1);
+                    break;
+
+                case overflow::fail:
+                    lock.unlock();
+                    g_rejected.fetch_add(1);
+
+                    w->skip("Concurrency queue is full");
+                    w->release();
+                    throw exception::queue("Concurrency queue is full");
+            }
+        }
+
+        queued();
+        w->next(nullptr);
+        if (m_tail)
+            m_tail->next(w);
+        else
+            m_head = w;
+
+        m_tail = w;
+        m_bounded.fetch_add(1);
+        m_depth.fetch_add(1);
+    }
+
+    if (dropped) {
+        g_dropped.fetch_add(1);
+        dropped->skip("Dropped from full concurrency queue");
+        dropped->release();
+    }
+
+    // start a thread if no thread is running, it keeps the channel alive until drained
+    bool expected = false;
+    if (m_running.compare_exchange_strong(expected, true)) {
+        std::thread t(&channel::run, shared_from_this());
+        t.detach();
+    }
+}
+
+worker *channel::take(worker *&ready) {
+    // workers taken from the inbox before are older than any queued since
+    worker *w = ready;
+
+    if (!w) {
+        // the bounded queue holds older workers than the inbox. Taking the inbox under the lock
+        // keeps the order with producers moving it to the bounded queue, the lock is taken once per
+        // batch and only contended while a limit is set
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_head)
+            return pop();
+
+        // restore submission order
+        worker *batch = m_inbox.exchange(nullptr);
+        while (batch) {
+            worker *next = batch->next();
+            batch->next(ready);
+            ready = batch;
+            batch = next;
+        }
+
+        w = ready;
+        if (!w)
+            return nullptr;
+    }
+
+    ready = w->next();
+    dequeued();
+    return w;
+}
+
+void channel::splice(worker *w) {
+    if (!w)
+        return;
+
+    // restore submission order
+    worker *ordered = nullptr;
+    u32 count = 0;
+    while (w) {
+        worker *next = w->next();
+        w->next(ordered);
+        ordered = w;
+        w = next;
+        count++;
+    }
+
+    if (m_tail)
+        m_tail->next(ordered);
+    else
+        m_head = ordered;
+
+    while (ordered->next()) ordered = ordered->next();
+
+    m_tail = ordered;
+    m_bounded.fetch_add(count);
+}
+
+worker *channel::pop() {
+    worker *w = m_head;
+    if (!w)
+        return nullptr;
+
+    m_head = w->next();
+    if (!m_head)
+        m_tail = nullptr;
+
+    m_bounded.fetch_sub(1);
+    dequeued();
+    return w;
+}
+
+void channel::dequeued() {
+    m_depth.fetch_sub(1);
+    g_depth.fetch_sub(1);
+}
+
+void channel::run() {
+    mysql_thread_init();
+
+    // workers taken from the inbox in submission order, only accessed by this thread
+    worker *ready = nullptr;
+
+    while (true) {
+        worker *w = take(ready);
+
+        if (!w) {
+            m_running = false;
+
+            // a producer might have queued right before the flag was cleared
+            bool expected = false;
+            if ((!m_inbox.load() && !m_bounded.load()) || !m_running.compare_exchange_strong(expected, true))
+                break;
+
+            continue;
+        }
+
+        // producers only wait while a limit is set
+        if (m_waiting.load()) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_space.notify_one();
+        }
+
+        if (w->expired(std::chrono::steady_clock::now())) {
+            g_expired.fetch_add(1);
+            w->skip("Deadline passed while queued");
+        } else {
+            // connections are established lazily, leasing does not fail on connection errors
+            if (m_session_pool && !m_session)
+                m_session = m_session_pool->acquire();
+
+            w->execute(m_session);
+        }
+
+        w->release();
+    }
+
+    mysql_thread_end();
+}
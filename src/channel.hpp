@@ -0,0 +1,101 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_CHANNEL_HPP_
+#define _MARIADB_CHANNEL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <mariadb++/connection_pool.hpp>
+
+namespace mariadb {
+class worker;
+
+namespace concurrency {
+//
+// Serializes workers: submitted workers run one after another in submission order, on a thread
+// which only exists while there is work. Different channels run in parallel.
+//
+// A channel created with a pool leases one connection on first use and runs all of its work on
+// it, so session state like temporary tables, variables and transactions carries over. The
+// default channel has no pool, each of its workers leases a connection of its own.
+//
+// The queue of each channel is bounded by set_queue_limit, workers past their deadline are
+// skipped instead of executed.
+//
+class channel : public std::enable_shared_from_this<channel> {
+public:
+    explicit channel(const connection_pool_ref &session_pool = connection_pool_ref());
+    ~channel();
+
+    //
+    // Queue a worker, takes over the reference of the caller. Depending on the overflow policy
+    // this blocks or drops the oldest worker while the queue is full, or releases the worker and
+    // throws exception::queue
+    //
+    void submit(worker *w);
+
+    //
+    // Wakes all producers blocked on a full queue of any channel, called when the limit changes
+    //
+    static void notify_limit_changed();
+
+private:
+    //
+    // Thread body, runs until the queue is drained
+    //
+    void run();
+
+    //
+    // Take the oldest worker, ready holds workers taken from the inbox before
+    //
+    worker *take(worker *&ready);
+
+    //
+    // Move the inbox to the end of the bounded queue, requires the lock
+    //
+    void splice(worker *w);
+
+    //
+    // Unlink the oldest worker of the bounded queue, requires the lock
+    //
+    worker *pop();
+
+    //
+    // Account for a worker leaving the queue
+    //
+    void dequeued();
+
+    // submitted workers not taken yet, most recent first, pushed without lock while unbounded and
+    // taken with the lock
+    std::atomic<worker *> m_inbox;
+    // guards the bounded queue
+    std::mutex m_lock;
+    // signaled whenever a worker leaves the queue while producers wait
+    std::condition_variable m_space;
+    // oldest and most recent worker of the bounded queue, used while a limit is set
+    worker *m_head;
+    worker *m_tail;
+    // number of workers in the bounded queue
+    std::atomic<u32> m_bounded;
+    // number of queued workers
+    std::atomic<u32> m_depth;
+    // number of producers waiting for space
+    std::atomic<u32> m_waiting;
+    // indicates whether a thread is draining the queue
+    std::atomic<bool> m_running;
+    // pool to lease the session from, empty for the default channel
+    connection_pool_ref m_session_pool;
+    // leased session, only accessed by the running thread, reset by the pool when released
+    connection_ref m_session;
+};
+}  // namespace concurrency
+}  // namespace mariadb
+
+#endif
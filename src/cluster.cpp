@@ -0,0 +1,193 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/cluster.hpp>
+#include <mariadb++/conversion_helper.hpp>
+
+using namespace mariadb;
+
+namespace {
+const char *g_replica_status = "SHOW SLAVE STATUS";
+const char *g_replica_lag_column = "Seconds_Behind_Master";
+
+//
+// Queries the replication lag of the server behind conn in seconds.
+// Returns false if replication is not running.
+//
+bool replication_lag(const connection_ref &conn, u64 &lag) {
+    result_set_ref rs = conn->query(g_replica_status);
+
+    // not configured as replica, there is nothing to lag behind
+    if (!rs || !rs->next()) {
+        lag = 0;
+        return true;
+    }
+
+    u32 index = rs->column_index(g_replica_lag_column);
+    if (index >= rs->column_count() || rs->get_is_null(index))
+        return false;
+
+    // servers report the lag with differing integer types, read any of them as signed
+    s64 seconds;
+    switch (rs->column_type(index)) {
+        case value::unsigned8:
+            seconds = rs->get_unsigned8(index);
+            break;
+        case value::signed8:
+            seconds = rs->get_signed8(index);
+            break;
+        case value::unsigned16:
+            seconds = rs->get_unsigned16(index);
+            break;
+        case value::signed16:
+            seconds = rs->get_signed16(index);
+            break;
+        case value::unsigned32:
+            seconds = rs->get_unsigned32(index);
+            break;
+        case value::signed32:
+            seconds = rs->get_signed32(index);
+            break;
+        case value::unsigned64:
+        case value::signed64:
+            seconds = rs->get_signed64(index);
+            break;
+
+        default:
+            seconds = string_cast<s64>(rs->get_string(index));
+            break;
+    }
+
+    lag = seconds < 0 ? 0 : static_cast<u64>(seconds);
+    return true;
+}
+}  // namespace
+
+cluster::cluster(const account_ref &primary, const std::vector<account_ref> &replicas, u32 max_idle)
+    : m_primary(connection_pool::create(primary, max_idle)),
+      m_next_replica(0),
+      m_max_replica_lag(0),
+      m_lag_check_interval(1000),
+      m_sticky_window(0) {
+    for (const account_ref &replica : replicas)
+        m_replicas.emplace_back(new replica_state(connection_pool::create(replica, max_idle)));
+}
+
+cluster_ref cluster::create(const account_ref &primary, const std::vector<account_ref> &replicas, u32 max_idle) {
+    return cluster_ref(new cluster(primary, replicas, max_idle));
+}
+
+connection_ref cluster::writer() {
+    return m_primary->acquire();
+}
+
+connection_ref cluster::reader() {
+    const size_t count = m_replicas.size();
+    const size_t first = m_next_replica++;
+    replica_state *best = nullptr;
+
+    // least outstanding connections wins, ties are spread by rotating the start
+    for (size_t i = 0; i < count; ++i) {
+        replica_state &replica = *m_replicas[(first + i) % count];
+
+        if ((!best || replica.m_pool->outstanding() < best->m_pool->outstanding()) && usable(replica))
+            best = &replica;
+    }
+
+    return best ? best->m_pool->acquire() : m_primary->acquire();
+}
+
+bool cluster::usable(replica_state &replica) {
+    const u32 max_lag = m_max_replica_lag;
+    if (max_lag == 0)
+        return true;
+
+    const clock::duration interval = std::chrono::milliseconds(m_lag_check_interval.load());
+    if (clock::now().time_since_epoch().count() - replica.m_checked < interval.count())
+        return replica.m_healthy;
+
+    // only one thread refreshes, the others use the previous state meanwhile
+    std::unique_lock<std::mutex> lock(replica.m_mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return replica.m_healthy;
+
+    bool healthy;
+    try {
+        u64 lag;
+        healthy = replication_lag(replica.m_pool->acquire(), lag) && lag <= max_lag;
+    } catch (const std::exception &) {
+        healthy = false;
+    }
+
+    replica.m_healthy = healthy;
+    replica.m_checked = clock::now().time_since_epoch().count();
+    return healthy;
+}
+
+cluster_session_ref cluster::create_session() {
+    return cluster_session_ref(new cluster_session(shared_from_this()));
+}
+
+const connection_pool_ref &cluster::primary() const {
+    return m_primary;
+}
+
+u32 cluster::replica_count() const {
+    return static_cast<u32>(m_replicas.size());
+}
+
+const connection_pool_ref &cluster::replica(u32 index) const {
+    return m_replicas.at(index)->m_pool;
+}
+
+u32 cluster::max_replica_lag() const {
+    return m_max_replica_lag;
+}
+
+void cluster::set_max_replica_lag(u32 seconds) {
+    m_max_replica_lag = seconds;
+}
+
+u32 cluster::lag_check_interval() const {
+    return m_lag_check_interval;
+}
+
+void cluster::set_lag_check_interval(u32 interval_ms) {
+    m_lag_check_interval = interval_ms;
+}
+
+u32 cluster::sticky_window() const {
+    return m_sticky_window;
+}
+
+void cluster::set_sticky_window(u32 window_ms) {
+    m_sticky_window = window_ms;
+}
+
+cluster_session::cluster_session(const cluster_ref &parent) : m_cluster(parent), m_written(false) {}
+
+connection_ref cluster_session::writer() {
+    mark_write();
+    return m_cluster->writer();
+}
+
+connection_ref cluster_session::reader() {
+    if (m_written) {
+        const u32 window = m_cluster->sticky_window();
+
+        if (window == 0 || cluster::clock::now() - m_last_write < std::chrono::milliseconds(window))
+            return m_cluster->writer();
+    }
+
+    return m_cluster->reader();
+}
+
+void cluster_session::mark_write() {
+    m_written = true;
+    m_last_write = cluster::clock::now();
+}
@@ -12,11 +12,10 @@
 #include <mariadb++/types.hpp>
 
 #include <atomic>
+#include <stdexcept>
 #include <thread>
-#include <mutex>
-
-#define LOCK_MUTEX() std::lock_guard<std::mutex> lock(g_mutex)
 
+#include "channel.hpp"
 #include "worker.hpp"
 #include "private.hpp"
 
@@ -24,97 +23,148 @@ using namespace mariadb;
 using namespace mariadb::concurrency;
 
 namespace {
-handle g_next_handle(0);
-account_ref g_account;
-std::mutex g_mutex;
-std::vector<worker *> g_querys_in;
-std::map<handle, worker *> g_querys_out;
-bool g_thread_running(false);
-
-typedef std::map<handle, worker *> map_t;
+// slots per segment of the handle table and maximum number of segments
+const u32 g_segment_size = 1024;
+const u32 g_max_segments = 4096;
 
 //
-// Worker thread
+// Slot of the handle table. Slots are never freed, a stale handle is detected by its generation
 //
-void worker_thread() {
-    g_thread_running = true;
+struct slot {
+    // generation of the handle owning this slot, odd while in use
+    std::atomic<u32> m_generation{0};
+    // number of threads currently reading m_worker
+    std::atomic<u32> m_readers{0};
+    // worker of the handle, valid while the generation matches
+    std::atomic<worker *> m_worker{nullptr};
+    // index + 1 of the next free slot, while on the free list
+    std::atomic<u32> m_next_free{0};
+};
 
-    mysql_thread_init();
+account_ref g_account;
+// pool all connections of the concurrency namespace are leased from
+connection_pool_ref g_pool;
+// runs work submitted without channel in order, each on a connection of its own
+const std::shared_ptr<channel> g_default_channel = std::make_shared<channel>();
+// handle table segments, allocated on first use
+std::atomic<slot *> g_segments[g_max_segments];
+// number of slots ever handed out
+std::atomic<u32> g_slot_count(0);
+// free list of slots: ABA tag in the upper, index + 1 of the first free slot in the lower half
+std::atomic<u64> g_free_head(0);
 
-    // breaking in infinite loop because checking g_querys_in would result in a race condition
-    while (true) {
-        worker *w = NULL;
-        {
-            LOCK_MUTEX();
-            auto possible_w = g_querys_in.begin();
-            if (possible_w == g_querys_in.end())
-                break;
+//
+// Get a slot by index, allocates its segment if needed
+//
+slot &slot_at(u32 index) {
+    std::atomic<slot *> &segment = g_segments[index / g_segment_size];
+    slot *slots = segment.load(std::memory_order_acquire);
+
+    if (!slots) {
+        slot *fresh = new slot[g_segment_size];
+
+        // lost the race, another thread allocated the segment meanwhile
+        if (segment.compare_exchange_strong(slots, fresh, std::memory_order_acq_rel))
+            slots = fresh;
+        else
+            delete[] fresh;
+    }
 
-            w = *possible_w;
-            g_querys_in.erase(possible_w);
-        }
+    return slots[index % g_segment_size];
+}
+
+//
+// Take a slot from the free list or a new one
+//
+u32 acquire_slot() {
+    u64 head = g_free_head.load(std::memory_order_acquire);
 
-        w->execute();
+    while (static_cast<u32>(head)) {
+        const u32 index = static_cast<u32>(head) - 1;
+        const u64 next = ((head >> 32) + 1) << 32 | slot_at(index).m_next_free.load(std::memory_order_relaxed);
 
-        if (!w->keep_handle())
-            delete w;
+        if (g_free_head.compare_exchange_weak(head, next, std::memory_order_acq_rel))
+            return index;
     }
 
-    g_thread_running = false;
-    mysql_thread_end();
+    const u32 index = g_slot_count.fetch_add(1);
+    if (index >= g_segment_size * g_max_segments)
+        throw std::length_error("Too many concurrency handles");
+
+    return index;
 }
 
 //
-// Start thread if no thread is running
+// Put a slot back on the free list
 //
-void start_thread() {
-    if (!g_thread_running) {
-        std::thread t(worker_thread);
-        t.detach();
-    }
+void release_slot(u32 index) {
+    slot &s = slot_at(index);
+    u64 head = g_free_head.load(std::memory_order_relaxed);
+
+    do {
+        s.m_next_free.store(static_cast<u32>(head), std::memory_order_relaxed);
+    } while (!g_free_head.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | (index + 1),
+                                                std::memory_order_acq_rel));
 }
 
 //
-// Get worker from handle
+// Calls fn with the worker of h while it is guaranteed to stay alive. Returns false if the
+// handle is unknown or was released
 //
-const worker &get_worker(handle h) {
-    LOCK_MUTEX();
-    const map_t::const_iterator w = g_querys_out.find(h);
+template <typename Fn>
+bool with_worker(handle h, Fn fn) {
+    const u32 index = static_cast<u32>(h);
+    const u32 generation = static_cast<u32>(h >> 32);
 
-    if (w != g_querys_out.end())
-        return *w->second;
+    if (!(generation & 1) || index >= g_slot_count.load())
+        return false;
 
-    static worker removed;
-    return removed;
+    slot &s = slot_at(index);
+
+    // announce the read before checking the generation, release_handle waits for readers
+    s.m_readers.fetch_add(1);
+    const bool valid = s.m_generation.load() == generation;
+
+    if (valid)
+        fn(*s.m_worker.load());
+
+    s.m_readers.fetch_sub(1);
+    return valid;
 }
 
 //
-// Add / remove a new query / command to the thread
+// Add a new query / command to a channel
 //
-handle add(const std::string &query, command::type command, bool keep_handle) {
-    LOCK_MUTEX();
-    worker *w = new worker(g_account, ++g_next_handle, keep_handle, command, query);
-    g_querys_in.push_back(w);
-
-    if (keep_handle)
-        g_querys_out[g_next_handle] = w;
-
-    start_thread();
+template <typename Job>
+handle add(const std::shared_ptr<channel> &target, Job &job, command::type command, bool keep_handle) {
+    handle h = 0;
+    u32 index = 0;
+
+    if (keep_handle) {
+        index = acquire_slot();
+        h = static_cast<handle>(slot_at(index).m_generation.load() + 1) << 32 | index;
+    }
 
-    return g_next_handle;
-}
+    worker *w = new worker(g_pool, h, keep_handle, command, job);
 
-handle add(statement_ref &statement, command::type command, bool keep_handle) {
-    LOCK_MUTEX();
-    worker *w = new worker(g_account, ++g_next_handle, keep_handle, command, statement);
-    g_querys_in.push_back(w);
+    // publish the handle before the worker can run
+    if (keep_handle) {
+        slot &s = slot_at(index);
 
-    if (keep_handle)
-        g_querys_out[g_next_handle] = w;
+        w->retain();
+        s.m_worker.store(w);
+        s.m_generation.fetch_add(1);
+    }
 
-    start_thread();
+    try {
+        target->submit(w);
+    } catch (const exception::queue &) {
+        // the caller never sees the handle
+        release_handle(h);
+        throw;
+    }
 
-    return g_next_handle;
+    return h;
 }
 }  // namespace
 
@@ -123,47 +173,107 @@ handle add(statement_ref &statement, command::type command, bool keep_handle) {
 //
 void concurrency::set_account(account_ref &account) {
     g_account = account;
+    g_pool = connection_pool::create(account);
+}
+
+//
+// Create a channel
+//
+channel_ref concurrency::create_channel() {
+    return std::make_shared<channel>(g_pool);
+}
+
+//
+// Begin a transaction
+//
+async_transaction_ref concurrency::begin_transaction(isolation::level level, const channel_ref &channel) {
+    return async_transaction_ref(new async_transaction(level, channel));
+}
+
+async_transaction::async_transaction(isolation::level level, const channel_ref &channel)
+    : m_level(level), m_channel(channel), m_committed(false) {}
+
+async_transaction &async_transaction::execute(const std::string &query) {
+    if (m_committed)
+        throw std::logic_error("Transaction already committed");
+
+    m_queries.push_back(query);
+    return *this;
+}
+
+std::future<u64> async_transaction::commit() {
+    if (m_committed)
+        throw std::logic_error("Transaction already committed");
+
+    m_committed = true;
+
+    worker *w = new worker(g_pool, m_level, std::move(m_queries));
+    std::future<u64> result = w->future();
+
+    // without channel a channel of its own runs the transaction on a connection of its own
+    channel_ref target = m_channel ? m_channel : std::make_shared<channel>();
+    target->submit(w);
+    return result;
 }
 
 //
 // Query status
 //
 status::type concurrency::worker_status(handle h) {
-    const worker &w = get_worker(h);
-    return w.status();
+    status::type result = status::removed;
+    with_worker(h, [&result](const worker &w) { result = w.status(); });
+    return result;
 }
 
 //
 // Query executed, result ready to be used
 //
 u64 concurrency::get_execute_result(handle h) {
-    const worker &w = get_worker(h);
-    return w.status() == status::removed ? 0 : w.result();
+    u64 result = 0;
+    with_worker(h, [&result](const worker &w) { result = w.result(); });
+    return result;
 }
 
 u64 concurrency::get_insert_result(handle h) {
-    const worker &w = get_worker(h);
-    return w.status() == status::removed ? 0 : w.result();
+    u64 result = 0;
+    with_worker(h, [&result](const worker &w) { result = w.result(); });
+    return result;
 }
 
 result_set_ref concurrency::get_query_result(handle h) {
-    const worker &w = get_worker(h);
-    return w.status() == status::removed ? result_set_ref() : w.result_set();
+    result_set_ref result;
+    with_worker(h, [&result](const worker &w) { result = w.result_set(); });
+    return result;
 }
 
 //
 // Execute a query
 //
 handle concurrency::execute(const std::string &query, bool keep_handle) {
-    return add(query, command::execute, keep_handle);
+    return add(g_default_channel, query, command::execute, keep_handle);
 }
 
 handle concurrency::insert(const std::string &query, bool keep_handle) {
-    return add(query, command::insert, keep_handle);
+    return add(g_default_channel, query, command::insert, keep_handle);
 }
 
 handle concurrency::query(const std::string &query, bool keep_handle) {
-    return add(query, command::query, keep_handle);
+    return add(g_default_channel, query, command::query, keep_handle);
+}
+
+//
+// Execute a query on a channel
+//
+handle concurrency::execute(const channel_ref &channel, const std::string &query, bool keep_handle) {
+    return add(channel, query, command::execute, keep_handle);
+}
+
+handle concurrency::insert(const channel_ref &channel, const std::string &query, bool keep_handle) {
+    return add(channel, query, command::insert, keep_handle);
+}
+
+handle concurrency::query(const channel_ref &channel, const std::string &query, bool keep_handle) {
+    return add(channel, query, command::query, keep_handle);
 }
 
 //
@@ -177,31 +287,43 @@ statement_ref concurrency::create_statement(const std::string &query) {
 }
 
 handle concurrency::execute(statement_ref &statement, bool keep_handle) {
-    return add(statement, command::execute, keep_handle);
+    return add(g_default_channel, statement, command::execute, keep_handle);
 }
 
 handle concurrency::insert(statement_ref &statement, bool keep_handle) {
-    return add(statement, command::insert, keep_handle);
+    return add(g_default_channel, statement, command::insert, keep_handle);
 }
 
 handle concurrency::query(statement_ref &statement, bool keep_handle) {
-    return add(statement, command::query, keep_handle);
+    return add(g_default_channel, statement, command::query, keep_handle);
 }
 
 //
 // Remove a query
 //
-// Please note, if a result_set is used, it must be done after the result_set is used...
+// Query results are materialized, they stay valid after the handle is released
 //
 void concurrency::release_handle(handle h) {
-    LOCK_MUTEX();
-    map_t::iterator w = g_querys_out.find(h);
+    const u32 index = static_cast<u32>(h);
+    u32 generation = static_cast<u32>(h >> 32);
+
+    if (!(generation & 1) || index >= g_slot_count.load())
+        return;
 
-    if (w == g_querys_out.end())
+    // invalidate the handle, only one release wins
+    slot &s = slot_at(index);
+    if (!s.m_generation.compare_exchange_strong(generation, generation + 1))
         return;
 
-    delete w->second;
-    g_querys_out.erase(w);
+    // wait for readers which saw the handle still valid
+    while (s.m_readers.load()) std::this_thread::yield();
+
+    s.m_worker.exchange(nullptr)->release();
+    release_slot(index);
+}
+
+void concurrency::cancel(handle h) {
+    with_worker(h, [](worker &w) { w.cancel(); });
 }
 
 bool concurrency::wait_handle(handle h, u64 wait_time_ms) {
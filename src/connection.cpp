@@ -10,11 +10,28 @@
 
 #include <mysql.h>
 #include <mariadb++/connection.hpp>
+#include "instrument.hpp"
 #include "private.hpp"
+#include "watchdog.hpp"
+
+#include <algorithm>
+#include <random>
+#include <thread>
 
 using namespace mariadb;
 
-connection::connection(const account_ref &account) : m_mysql(NULL), m_auto_commit(true), m_account(account) {}
+namespace {
+//
+// Gets a random number of milliseconds in [0, bound]
+//
+u64 jitter(u64 bound) {
+    static thread_local std::minstd_rand engine(std::random_device{}());
+    return std::uniform_int_distribution<u64>(0, bound)(engine);
+}
+}  // namespace
+
+connection::connection(const account_ref &account)
+    : m_mysql(NULL), m_auto_commit(true), m_account(account), m_query_timeout(0), m_session_id(0) {}
 
 connection_ref connection::create(const account_ref &account) {
     return connection_ref(new connection(account));
@@ -65,6 +82,18 @@ account_ref connection::account() const {
     return m_account;
 }
 
+u64 connection::thread_id() const {
+    return m_mysql ? mysql_thread_id(m_mysql) : 0;
+}
+
+u64 connection::query_timeout() const {
+    return m_query_timeout;
+}
+
+void connection::set_query_timeout(u64 timeout_ms) {
+    m_query_timeout = timeout_ms;
+}
+
 bool connection::auto_commit() const {
     return m_auto_commit;
 }
@@ -84,8 +113,15 @@ bool connection::set_auto_commit(bool auto_commit) {
 }
 
 bool connection::connect() {
-    if (connected())
+    if (connected()) {
+        // the client library may have reconnected inside the ping, which loses the session settings
+        if (mysql_thread_id(m_mysql) != m_session_id && !setup_session())
+            MARIADB_CONN_CLOSE_ERROR(m_mysql);
+
         return true;
+    }
+
+    instrument::scope scope(operation::connect, this);
 
     if (m_mysql == nullptr) {
         m_mysql = mysql_init(nullptr);
@@ -117,12 +153,25 @@ bool connection::connect() {
                             CLIENT_MULTI_STATEMENTS))
         MARIADB_CONN_ERROR(m_mysql);
 
-    if (!set_auto_commit(m_account->auto_commit()))
+    if (!setup_session())
         MARIADB_CONN_CLOSE_ERROR(m_mysql);
 
+    return true;
+}
+
+bool connection::setup_session() {
+    // set first, applying the settings calls connect() again
+    m_session_id = mysql_thread_id(m_mysql);
+
+    // a new session starts with the defaults of the server, the cached setting does not apply
+    if (mysql_autocommit(m_mysql, m_account->auto_commit()))
+        return false;
+
+    m_auto_commit = m_account->auto_commit();
+
     if (!m_account->schema().empty()) {
-        if (!set_schema(m_account->schema().c_str()))
-            MARIADB_CONN_CLOSE_ERROR(m_mysql);
+        if (!set_schema(m_account->schema()))
+            return false;
     }
 
     //
@@ -130,12 +179,27 @@ bool connection::connect() {
     //
     for (auto &pair : m_account->options()) {
         if (1 != execute("SET OPTION " + pair.first + "=" + pair.second))
-            MARIADB_CONN_CLOSE_ERROR(m_mysql);
+            return false;
     }
 
     return true;
 }
 
+bool connection::connect(error_info *error) {
+    if (!error)
+        return connect();
+
+    // failing to connect is expected for the non-throwing calls, the error was reported already
+    try {
+        return connect();
+    } catch (const exception::base &e) {
+        set_error_info(*error, e.error_id(), e.what(), e.sqlstate(),
+                       dynamic_cast<const exception::timeout *>(&e) ? exception_type::timeout
+                                                                    : exception_type::connection);
+        return false;
+    }
+}
+
 void connection::disconnect() {
     if (!m_mysql)
         return;
@@ -146,27 +210,111 @@ void connection::disconnect() {
     m_mysql = nullptr;
 }
 
-result_set_ref connection::query(const std::string &query) {
-    result_set_ref rs;
-
-    if (!connect())
-        return rs;
+bool connection::reset() {
+    if (!m_mysql)
+        return true;
 
-    if (mysql_real_query(m_mysql, query.c_str(), query.size()))
+#if MARIADB_HAS_RESET_CONNECTION
+    if (mysql_reset_connection(m_mysql))
         MARIADB_CONN_ERROR(m_mysql);
 
-    rs.reset(new result_set(this));
+    m_schema.clear();
+    if (!m_charset.empty() && mysql_set_character_set(m_mysql, m_charset.c_str()))
+        MARIADB_CONN_CLOSE_ERROR(m_mysql);
+
+    if (!setup_session())
+        MARIADB_CONN_CLOSE_ERROR(m_mysql);
+#else
+    disconnect();
+#endif
+
+    return true;
+}
+
+result_set_ref connection::query(const std::string &query) {
+    result_set_ref rs;
+    run_query(query, rs, nullptr);
     return rs;
 }
 
 u64 connection::execute(const std::string &query) {
-    if (!connect())
-        return 0;
+    u64 affected_rows = 0;
+    run_execute(query, affected_rows, nullptr);
+    return affected_rows;
+}
+
+u64 connection::insert(const std::string &query) {
+    u64 id = 0;
+    run_insert(query, id, nullptr);
+    return id;
+}
+
+expected<result_set_ref> connection::try_query(const std::string &query) {
+    result_set_ref rs;
+    error_info error;
 
+    if (!run_query(query, rs, &error))
+        return error;
+
+    return rs;
+}
+
+expected<u64> connection::try_execute(const std::string &query) {
     u64 affected_rows = 0;
+    error_info error;
+
+    if (!run_execute(query, affected_rows, &error))
+        return error;
+
+    return affected_rows;
+}
+
+expected<u64> connection::try_insert(const std::string &query) {
+    u64 id = 0;
+    error_info error;
+
+    if (!run_insert(query, id, &error))
+        return error;
+
+    return id;
+}
+
+bool connection::run_query(const std::string &query, result_set_ref &result, error_info *error) {
+    if (!connect(error))
+        return false;
+
+    instrument::scope scope(operation::query, this, query.c_str(), query.size());
+    watchdog::guard guard(m_account, thread_id(), m_query_timeout);
 
     if (mysql_real_query(m_mysql, query.c_str(), query.size()))
-        MARIADB_CONN_ERROR(m_mysql);
+        MARIADB_CONN_GUARD_FAIL(m_mysql, guard, scope, query, error);
+
+    // storing the result is part of the call, an interrupted store fails like the query
+    MYSQL_RES *stored = (m_account->store_result() ? mysql_store_result : mysql_use_result)(m_mysql);
+    if (!stored && mysql_field_count(m_mysql))
+        MARIADB_CONN_GUARD_FAIL(m_mysql, guard, scope, query, error);
+
+    // rows of a used result are only known once all were fetched
+    if (stored && m_account->store_result())
+        scope.rows(mysql_num_rows(stored));
+
+    result.reset(new result_set(stored));
+    return true;
+}
+
+bool connection::run_execute(const std::string &query, u64 &affected_rows, error_info *error) {
+    if (!connect(error))
+        return false;
+
+    return run_statements(query, affected_rows, error);
+}
+
+bool connection::run_statements(const std::string &query, u64 &affected_rows, error_info *error) {
+    instrument::scope scope(operation::execute, this, query.c_str(), query.size());
+    watchdog::guard guard(m_account, thread_id(), m_query_timeout);
+
+    if (mysql_real_query(m_mysql, query.c_str(), query.size()))
+        MARIADB_CONN_GUARD_FAIL(m_mysql, guard, scope, query, error);
 
     int status;
     do {
@@ -177,24 +325,30 @@ u64 connection::execute(const std::string &query) {
         else if (mysql_field_count(m_mysql) == 0)
             affected_rows += mysql_affected_rows(m_mysql);
         else
-            MARIADB_CONN_ERROR(m_mysql);
+            MARIADB_CONN_GUARD_FAIL(m_mysql, guard, scope, query, error);
 
         status = mysql_next_result(m_mysql);
         if (status > 0)
-            MARIADB_CONN_ERROR(m_mysql);
+            MARIADB_CONN_GUARD_FAIL(m_mysql, guard, scope, query, error);
     } while (status == 0);
 
-    return affected_rows;
+    scope.rows(affected_rows);
+    return true;
 }
 
-u64 connection::insert(const std::string &query) {
-    if (!connect())
-        return 0;
+bool connection::run_insert(const std::string &query, u64 &id, error_info *error) {
+    if (!connect(error))
+        return false;
+
+    instrument::scope scope(operation::insert, this, query.c_str(), query.size());
+    watchdog::guard guard(m_account, thread_id(), m_query_timeout);
 
     if (mysql_real_query(m_mysql, query.c_str(), query.size()))
-        MARIADB_CONN_ERROR(m_mysql);
+        MARIADB_CONN_GUARD_FAIL(m_mysql, guard, scope, query, error);
 
-    return mysql_insert_id(m_mysql);
+    scope.rows(mysql_affected_rows(m_mysql));
+    id = mysql_insert_id(m_mysql);
+    return true;
 }
 
 statement_ref connection::create_statement(const std::string &query) {
@@ -204,9 +358,60 @@ statement_ref connection::create_statement(const std::string &query) {
     return statement_ref(new statement(this, query));
 }
 
-transaction_ref connection::create_transaction(isolation::level level, bool consistent_snapshot) {
+transaction_ref connection::create_transaction(isolation::level level, bool consistent_snapshot, bool read_only) {
     if (!connect())
         return transaction_ref();
 
-    return transaction_ref(new transaction(this, level, consistent_snapshot));
+    return transaction_ref(new transaction(this, level, consistent_snapshot, read_only));
+}
+
+u32 connection::run_in_transaction(const std::function<void(transaction &)> &fn, const retry_policy &policy) {
+    for (u32 attempt = 1;; attempt++) {
+        try {
+            transaction_ref tx = create_transaction(policy.level, policy.consistent_snapshot, policy.read_only);
+            if (!tx)
+                return 0;
+
+            fn(*tx);
+            tx->commit();
+            return attempt;
+        } catch (const exception::base &e) {
+            // the transaction is already rolled back by its destruction
+            const error_category::type category = e.category();
+            const bool retry = category == error_category::deadlock ||
+                               (category == error_category::lock_wait_timeout && policy.retry_lock_wait_timeout);
+
+            if (!retry || attempt >= policy.max_attempts)
+                throw;
+        }
+
+        // full jitter: waiting a random time up to the exponential bound keeps the contenders of a
+        // deadlock from colliding again
+        const u32 shift = std::min<u32>(attempt - 1, 20);
+        const u64 bound = std::min<u64>(static_cast<u64>(policy.base_delay_ms) << shift, policy.max_delay_ms);
+        if (bound)
+            std::this_thread::sleep_for(std::chrono::milliseconds(jitter(bound)));
+    }
+}
+
+std::string connection::cache_scope() const {
+    std::string scope = m_account->host_name();
+
+    scope.push_back('\0');
+    scope += m_account->unix_socket();
+    scope.push_back('\0');
+    scope += std::to_string(m_account->port());
+    scope.push_back('\0');
+    scope += m_account->user_name();
+    scope.push_back('\0');
+    scope += m_schema;
+    scope.push_back('\0');
+    scope += m_charset;
+    scope.push_back('\0');
+    return scope;
+}
+
+void connection::commit_transaction() {
+    if (mysql_commit(m_mysql))
+        MARIADB_CONN_ERROR(m_mysql);
 }
@@ -0,0 +1,128 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/connection_pool.hpp>
+
+#include "instrument.hpp"
+
+using namespace mariadb;
+
+connection_pool::connection_pool(const account_ref &account, u32 max_idle, u32 max_size)
+    : m_account(account), m_max_idle(max_idle), m_max_size(max_size), m_outstanding(0) {}
+
+connection_pool_ref connection_pool::create(const account_ref &account, u32 max_idle, u32 max_size) {
+    return connection_pool_ref(new connection_pool(account, max_idle, max_size));
+}
+
+connection_pool::~connection_pool() {
+    clear();
+}
+
+connection_ref connection_pool::acquire() {
+    connection_ref conn;
+    {
+        instrument::scope scope(operation::pool_wait, nullptr);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_released.wait(lock, [this] { return m_max_size == 0 || m_outstanding < m_max_size; });
+
+        if (!m_idle.empty()) {
+            conn = m_idle.back();
+            m_idle.pop_back();
+        }
+
+        ++m_outstanding;
+    }
+
+    // connections are established lazily on first use
+    if (!conn)
+        conn = connection::create(m_account);
+
+    // the returned reference shares the connection, the owning reference is kept by the deleter
+    std::weak_ptr<connection_pool> pool = shared_from_this();
+    return connection_ref(conn.get(), [pool, conn](connection *) {
+        connection_pool_ref owner = pool.lock();
+        if (owner)
+            owner->release(conn);
+    });
+}
+
+void connection_pool::release(const connection_ref &conn) {
+    bool reuse = true;
+
+    // never hand out a connection with state left by the previous lease
+    try {
+        reuse = conn->reset();
+    } catch (const std::exception &) {
+        reuse = false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (reuse && m_idle.size() < m_max_idle)
+            m_idle.push_back(conn);
+
+        --m_outstanding;
+    }
+
+    m_released.notify_one();
+}
+
+const account_ref &connection_pool::account() const {
+    return m_account;
+}
+
+u32 connection_pool::outstanding() const {
+    return m_outstanding;
+}
+
+u32 connection_pool::idle() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<u32>(m_idle.size());
+}
+
+u32 connection_pool::max_idle() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_max_idle;
+}
+
+void connection_pool::set_max_idle(u32 max_idle) {
+    std::vector<connection_ref> surplus;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_idle = max_idle;
+
+        if (m_idle.size() > m_max_idle) {
+            surplus.assign(m_idle.begin() + m_max_idle, m_idle.end());
+            m_idle.resize(m_max_idle);
+        }
+    }
+}
+
+u32 connection_pool::max_size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_max_size;
+}
+
+void connection_pool::set_max_size(u32 max_size) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_size = max_size;
+    }
+
+    m_released.notify_all();
+}
+
+void connection_pool::clear() {
+    std::vector<connection_ref> idle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        idle.swap(m_idle);
+    }
+
+    // connections disconnect on destruction outside of the lock
+}
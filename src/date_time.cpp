@@ -23,21 +23,20 @@ namespace {
 const u8 g_month_lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 }
 
-#define MS_PER_SEC 1000
-#define MS_PER_MIN (MS_PER_SEC * 60)
-#define MS_PER_HOUR (MS_PER_MIN * 60)
-#define MS_PER_DAY (MS_PER_HOUR * 24)
+#define US_PER_MS 1000
+#define US_PER_SEC (US_PER_MS * 1000)
+#define US_PER_MIN (US_PER_SEC * 60)
+#define US_PER_HOUR (US_PER_MIN * 60ll)
+#define US_PER_DAY (US_PER_HOUR * 24)
 
 date_time::date_time(u16 year, u8 month, u8 day, u8 hour, u8 minute, u8 second, u16 millisecond) : time() {
     set(year, month, day, hour, minute, second, millisecond);
 }
 
-date_time::date_time(const date_time &dt) : time() {
-    set(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second(), dt.millisecond());
-}
+date_time::date_time(const date_time &dt) : time(dt), m_year(dt.m_year), m_month(dt.m_month), m_day(dt.m_day) {}
 
-date_time::date_time(const time &t) : time() {
-    set(1900, 1, 1, t.hour(), t.minute(), t.second(), t.millisecond());
+date_time::date_time(const time &t) : time(t) {
+    set(1900, 1, 1);
 }
 
 date_time::date_time(const tm &t) : time() {
@@ -45,14 +44,15 @@ date_time::date_time(const tm &t) : time() {
 }
 
 date_time::date_time(const time_t &time) : mariadb::time() {
-    tm t;
-    localtime_safe(&t, &time);
+    set_since_epoch(static_cast<s64>(time) * US_PER_SEC);
+}
 
-    set(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, 0);
+date_time::date_time(const MYSQL_TIME &t) : time(t) {
+    set(t.year, t.month, t.day);
 }
 
-date_time::date_time(const MYSQL_TIME &t) : time() {
-    set(t.year, t.month, t.day, t.hour, t.minute, t.second, t.second_part / 1000);
+date_time::date_time(const std::chrono::system_clock::time_point &time_point) : time() {
+    this->time_point(time_point);
 }
 
 date_time::date_time(const std::string &dt) : time() {
@@ -82,7 +82,8 @@ int date_time::compare(const date_time &dt) const {
 }
 
 date_time &date_time::operator=(const date_time &dt) {
-    set(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second(), dt.millisecond());
+    time::operator=(dt);
+    set(dt.year(), dt.month(), dt.day());
     return *this;
 }
 
@@ -204,22 +205,10 @@ date_time date_time::add_months(s32 months) const {
     if (!months)
         return tmp;
 
-    s32 years = months / 12;
-
-    months = (months % 12) + month();
-
-    if (months >= 12) {
-        ++years;
-        months %= 12;
-    } else if (months < 0) {
-        --years;
-        months = 12 - months;
-    }
-
-    if (years)
-        tmp = tmp.add_years(years);
-
-    tmp.month(months);
+    // count months from year 0 to wrap years in one step
+    const s64 total = static_cast<s64>(year()) * 12 + (month() - 1) + months;
+    tmp = tmp.add_years(static_cast<s32>(floor_div(total, 12) - year()));
+    tmp.month(static_cast<u8>(total - floor_div(total, 12) * 12 + 1));
     return tmp;
 }
 
@@ -229,120 +218,27 @@ date_time date_time::add_days(s32 days) const {
     if (!days)
         return tmp;
 
-    s32 dir = days > 0 ? 1 : -1;
-    u16 y = year();
-    s32 days_in = days_in_year(y);
-    s32 day_of = day_of_year() + days;
-
-    while (day_of > days_in || day_of < 0) {
-        day_of -= days_in * dir;
-        y += dir;
-        days_in = days_in_year(y);
-    }
-
-    tmp.year(y);
-    tmp.day_of_year(day_of);
+    date_time date = civil_from_days(days_from_civil(year(), month(), day()) + days);
+    tmp.m_year = date.m_year;
+    tmp.m_month = date.m_month;
+    tmp.m_day = date.m_day;
     return tmp;
 }
 
 date_time date_time::add_hours(s32 hours) const {
-    date_time tmp = *this;
-
-    if (!hours)
-        return tmp;
-
-    s32 days = hours / 24;
-
-    hours = (hours % 24) + hour();
-
-    if (hours >= 24) {
-        ++days;
-        hours %= 24;
-    } else if (hours < 0) {
-        --days;
-        hours = 24 - hours;
-    }
-
-    if (days)
-        tmp = tmp.add_days(days);
-
-    tmp.hour(hours);
-    return tmp;
+    return add(std::chrono::microseconds(static_cast<s64>(hours) * US_PER_HOUR));
 }
 
 date_time date_time::add_minutes(s32 minutes) const {
-    date_time tmp = *this;
-
-    if (!minutes)
-        return tmp;
-
-    s32 hours = minutes / 60;
-
-    minutes = (minutes % 60) + minute();
-
-    if (minutes >= 60) {
-        ++hours;
-        minutes %= 60;
-    } else if (minutes < 0) {
-        --hours;
-        minutes = 60 - minutes;
-    }
-
-    if (hours > 0)
-        tmp = tmp.add_hours(hours);
-
-    tmp.minute(minutes);
-    return tmp;
+    return add(std::chrono::microseconds(static_cast<s64>(minutes) * US_PER_MIN));
 }
 
 date_time date_time::add_seconds(s32 seconds) const {
-    date_time tmp = *this;
-
-    if (!seconds)
-        return tmp;
-
-    s32 minutes = seconds / 60;
-
-    seconds = (seconds % 60) + second();
-
-    if (seconds >= 60) {
-        ++minutes;
-        seconds %= 60;
-    } else if (seconds < 0) {
-        --minutes;
-        seconds = 60 - seconds;
-    }
-
-    if (minutes > 0)
-        tmp = tmp.add_minutes(minutes);
-
-    tmp.second(seconds);
-    return tmp;
+    return add(std::chrono::microseconds(static_cast<s64>(seconds) * US_PER_SEC));
 }
 
 date_time date_time::add_milliseconds(s32 milliseconds) const {
-    date_time tmp = *this;
-
-    if (!milliseconds)
-        return tmp;
-
-    s32 seconds = milliseconds / 1000;
-
-    milliseconds = (milliseconds % 1000) + millisecond();
-
-    if (milliseconds >= 1000) {
-        ++seconds;
-        milliseconds %= 1000;
-    } else if (milliseconds < 0) {
-        --seconds;
-        milliseconds = 1000 - milliseconds;
-    }
-
-    if (seconds > 0)
-        tmp = tmp.add_seconds(seconds);
-
-    tmp.millisecond(milliseconds);
-    return tmp;
+    return add(std::chrono::microseconds(static_cast<s64>(milliseconds) * US_PER_MS));
 }
 
 date_time date_time::subtract(const time_span &dur) const {
@@ -354,98 +250,41 @@ date_time date_time::subtract(const time_span &dur) const {
 }
 
 date_time date_time::add(const time_span &dur) const {
-    s32 negate = dur.negative() ? -1 : 1;
-    date_time tmp = *this;
-
-    tmp = tmp.add_days(negate * dur.days());
-    tmp = tmp.add_hours(negate * dur.hours());
-    tmp = tmp.add_minutes(negate * dur.minutes());
-    tmp = tmp.add_seconds(negate * dur.seconds());
-    tmp = tmp.add_milliseconds(negate * dur.milliseconds());
-    return tmp;
+    const s64 ms = static_cast<s64>(dur.total_milliseconds());
+    return add(std::chrono::milliseconds(dur.negative() ? -ms : ms));
 }
 
 date_time date_time::add(const time &t) const {
-    date_time tmp = *this;
-
-    tmp = tmp.add_hours(t.hour());
-    tmp = tmp.add_minutes(t.minute());
-    tmp = tmp.add_seconds(t.second());
-    tmp = tmp.add_milliseconds(t.millisecond());
-    return tmp;
+    return add(t.time_of_day());
 }
 
 date_time date_time::substract(const time &t) const {
-    date_time tmp = *this;
-
-    tmp = tmp.add_hours(-1 * t.hour());
-    tmp = tmp.add_minutes(-1 * t.minute());
-    tmp = tmp.add_seconds(-1 * t.second());
-    tmp = tmp.add_milliseconds(-1 * t.millisecond());
-    return tmp;
+    return add(-t.time_of_day());
 }
 
-time_span date_time::time_between(const date_time &dt) const {
-    if (dt == *this)
-        return time_span();
-
-    if (dt > *this) {
-        time_span dur = dt.time_between(*this);
-        dur.negative(true);
-        return dur;
-    }
-
-    s64 ms = (hour() * MS_PER_HOUR) + (minute() * MS_PER_MIN) + (second() * MS_PER_SEC) + millisecond();
-    s64 dt_ms = (dt.hour() * MS_PER_HOUR) + (dt.minute() * MS_PER_MIN) + (dt.second() * MS_PER_SEC) + dt.millisecond();
-    s64 total_ms = 0;
-    date_time stop_date_time;
-
-    //
-    // Need to stop one day after in this case
-    //
-    if (dt_ms > ms) {
-        stop_date_time = dt.add_days(1);
-        total_ms = MS_PER_DAY - (dt_ms - ms);
-    } else {
-        stop_date_time = dt;
-        total_ms = ms - dt_ms;
-    }
-
-    u32 hours = static_cast<u32>(total_ms / MS_PER_HOUR);
-    total_ms = total_ms % MS_PER_HOUR;
-
-    u32 minutes = static_cast<u32>(total_ms / MS_PER_MIN);
-    total_ms = total_ms % MS_PER_MIN;
-
-    u32 seconds = static_cast<u32>(total_ms / MS_PER_SEC);
-    total_ms = total_ms % MS_PER_SEC;
-
-    u32 milliseconds = static_cast<u32>(total_ms);
+date_time date_time::add(const std::chrono::microseconds &dur) const {
+    date_time tmp = *this;
 
-    u32 totaldays = 0;
-    u16 currentyear = year();
+    if (!dur.count())
+        return tmp;
 
-    while (currentyear > stop_date_time.year()) {
-        if (currentyear == year())
-            totaldays += day_of_year();
-        else
-            totaldays += days_in_year(currentyear);
+    const s64 total = (time_of_day() + dur).count();
+    const s64 days = floor_div(total, US_PER_DAY);
 
-        currentyear--;
-    }
+    if (days)
+        tmp = tmp.add_days(static_cast<s32>(days));
 
-    if (year() == stop_date_time.year())
-        totaldays += day_of_year() - stop_date_time.day_of_year();
-    else
-        totaldays += days_in_year(currentyear) - stop_date_time.day_of_year();
+    tmp.set_time_of_day(total - days * US_PER_DAY);
+    return tmp;
+}
 
-    /*while (currentday > stop_date_time.day_of_year())
-    {
-            totaldays++;
-            currentday--;
-    }*/
+time_span date_time::time_between(const date_time &dt) const {
+    return time_span_from_ms(duration_since(dt).count() / US_PER_MS);
+}
 
-    return time_span(totaldays, hours, minutes, seconds, milliseconds, false);
+std::chrono::microseconds date_time::duration_since(const date_time &dt) const {
+    const s64 days = days_from_civil(year(), month(), day()) - days_from_civil(dt.year(), dt.month(), dt.day());
+    return std::chrono::microseconds(days * US_PER_DAY) + time_of_day() - dt.time_of_day();
 }
 
 bool date_time::is_valid() const {
@@ -484,32 +323,47 @@ u8 date_time::days_in_month(u16 year, u8 month) {
     return days_in_month;
 }
 
-u16 date_time::day_of_year(u16 year, u8 _month, u8 day) {
-    u16 day_of_year = 0;
-
-    for (u8 month = 1; month < _month; month++) day_of_year += date_time::days_in_month(year, month);
-
-    day_of_year += day;
-
-    return day_of_year;
+u16 date_time::day_of_year(u16 year, u8 month, u8 day) {
+    return static_cast<u16>(days_from_civil(year, month, day) - days_from_civil(year, 1, 1) + 1);
 }
 
 date_time date_time::reverse_day_of_year(u16 year, u16 day_of_year) {
-    u8 month;
+    return civil_from_days(days_from_civil(year, 1, 1) + day_of_year - 1);
+}
 
-    for (month = 1; month < 12; month++) {
-        u32 days = date_time::days_in_month(year, month);
+s64 date_time::days_from_civil(s32 year, u32 month, u32 day) {
+    // see http://howardhinnant.github.io/date_algorithms.html, era of 400 years
+    year -= month <= 2;
+    const s64 era = floor_div(year, 400);
+    const u32 year_of_era = static_cast<u32>(year - era * 400);
+    const u32 day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const u32 day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
 
-        if (days >= day_of_year)
-            break;
+    return era * 146097 + static_cast<s64>(day_of_era) - 719468;
+}
 
-        day_of_year -= days;
-    }
+date_time date_time::civil_from_days(s64 days) {
+    days += 719468;
+    const s64 era = floor_div(days, 146097);
+    const u32 day_of_era = static_cast<u32>(days - era * 146097);
+    const u32 year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const u32 day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const u32 month_index = (5 * day_of_year + 2) / 153;
+    const u32 month = month_index < 10 ? month_index + 3 : month_index - 9;
+    const s64 year = static_cast<s64>(year_of_era) + era * 400 + (month <= 2);
 
-    return date_time(year, month, static_cast<u8>(day_of_year));
+    date_time result;
+    result.m_year = static_cast<u16>(year);
+    result.m_month = static_cast<u8>(month);
+    result.m_day = static_cast<u8>(day_of_year - (153 * month_index + 2) / 5 + 1);
+    return result;
 }
 
 time_t date_time::mktime() const {
+    return static_cast<time_t>(days_from_civil(year(), month(), day()) * 86400 + time::mktime());
+}
+
+time_t date_time::mktime_local() const {
     tm t;
 
     t.tm_year = year() - 1900;
@@ -518,6 +372,8 @@ time_t date_time::mktime() const {
     t.tm_hour = hour();
     t.tm_min = minute();
     t.tm_sec = second();
+    // let the C library determine whether daylight saving time is in effect
+    t.tm_isdst = -1;
 
     return ::mktime(&t);
 }
@@ -531,18 +387,42 @@ MYSQL_TIME date_time::mysql_time() const {
     t.hour = hour();
     t.minute = minute();
     t.second = second();
-    t.second_part = millisecond() * 1000u;
+    t.second_part = microsecond();
     t.neg = false;
-    t.time_type = !t.hour && !t.minute && !t.second ? MYSQL_TIMESTAMP_DATE : MYSQL_TIMESTAMP_DATETIME;
+    t.time_type = !t.hour && !t.minute && !t.second && !t.second_part ? MYSQL_TIMESTAMP_DATE : MYSQL_TIMESTAMP_DATETIME;
 
     return t;
 }
 
-double date_time::diff_time(const date_time &dt) const {
-    time_t time_val = mktime();
-    time_t dt_time_val = dt.mktime();
+std::chrono::system_clock::time_point date_time::time_point() const {
+    using namespace std::chrono;
 
-    return ::difftime(time_val, dt_time_val);
+    const microseconds since_epoch = microseconds(days_from_civil(year(), month(), day()) * US_PER_DAY) + time_of_day();
+    return system_clock::time_point(duration_cast<system_clock::duration>(since_epoch));
+}
+
+std::chrono::system_clock::time_point date_time::time_point(const std::chrono::system_clock::time_point &time_point) {
+    using namespace std::chrono;
+
+    // round towards negative infinity, the clock might be more precise than microseconds
+    microseconds since_epoch = duration_cast<microseconds>(time_point.time_since_epoch());
+    if (since_epoch > time_point.time_since_epoch())
+        since_epoch -= microseconds(1);
+
+    set_since_epoch(since_epoch.count());
+    return this->time_point();
+}
+
+void date_time::set_since_epoch(s64 us) {
+    const s64 days = floor_div(us, US_PER_DAY);
+    const date_time date = civil_from_days(days);
+
+    set(date.year(), date.month(), date.day());
+    set_time_of_day(us - days * US_PER_DAY);
+}
+
+double date_time::diff_time(const date_time &dt) const {
+    return static_cast<double>(duration_since(dt).count()) / US_PER_SEC;
 }
 
 date_time date_time::date() const {
@@ -557,20 +437,22 @@ date_time date_time::now() {
     tm ts;
     localtime_safe(&ts, &local_time);
 
-    auto millis = duration_cast<milliseconds>(now.time_since_epoch()).count() % 1000;
-    return date_time(ts).add_milliseconds(static_cast<s32>(millis));
+    date_time result(ts);
+    result.m_microsecond = static_cast<u32>(duration_cast<microseconds>(now.time_since_epoch()).count() % US_PER_SEC);
+    return result;
 }
 
 date_time date_time::now_utc() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
+    date_time result;
+    result.set_since_epoch(realtime_microseconds());
+    return result;
+}
 
-    time_t utc_time = system_clock::to_time_t(now);
-    tm ts;
-    gmtime_safe(&ts, &utc_time);
+date_time date_time::from_local_time(const time_t &time) {
+    tm t;
+    localtime_safe(&t, &time);
 
-    auto millis = duration_cast<milliseconds>(now.time_since_epoch()).count() % 1000;
-    return date_time(ts).add_milliseconds(static_cast<s32>(millis));
+    return date_time(t);
 }
 
 bool date_time::set(const std::string &dt) {
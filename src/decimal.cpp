@@ -0,0 +1,349 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <mariadb++/decimal.hpp>
+
+using namespace mariadb;
+
+namespace {
+const u64 g_pow10[] = {1ull,
+                       10ull,
+                       100ull,
+                       1000ull,
+                       10000ull,
+                       100000ull,
+                       1000000ull,
+                       10000000ull,
+                       100000000ull,
+                       1000000000ull,
+                       10000000000ull,
+                       100000000000ull,
+                       1000000000000ull,
+                       10000000000000ull,
+                       100000000000000ull,
+                       1000000000000000ull,
+                       10000000000000000ull,
+                       100000000000000000ull,
+                       1000000000000000000ull,
+                       10000000000000000000ull};
+const u32 g_max_pow10 = 19;
+
+const u64 g_max_magnitude = static_cast<u64>(std::numeric_limits<s64>::max());
+
+u64 magnitude(s64 value) {
+    return value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+}
+
+//
+// Combines sign and magnitude, returns false on overflow
+//
+bool from_magnitude(u64 mag, bool negative, s64 &result) {
+    if (mag > g_max_magnitude + (negative ? 1 : 0))
+        return false;
+
+    result = negative ? static_cast<s64>(0 - mag) : static_cast<s64>(mag);
+    return true;
+}
+
+bool checked_multiply(s64 a, s64 b, s64 &result) {
+    const u64 ma = magnitude(a), mb = magnitude(b);
+    if (ma != 0 && mb > (g_max_magnitude + 1) / ma)
+        return false;
+
+    return from_magnitude(ma * mb, (a < 0) != (b < 0), result);
+}
+
+bool checked_add(s64 a, s64 b, s64 &result) {
+    if ((b > 0 && a > std::numeric_limits<s64>::max() - b) || (b < 0 && a < std::numeric_limits<s64>::min() - b))
+        return false;
+
+    result = a + b;
+    return true;
+}
+
+//
+// Scales value up by digits, returns false on overflow
+//
+bool scale_up(s64 value, u32 digits, s64 &result) {
+    if (value == 0) {
+        result = 0;
+        return true;
+    }
+
+    return digits < g_max_pow10 && checked_multiply(value, static_cast<s64>(g_pow10[digits]), result);
+}
+
+void throw_overflow() {
+    throw std::overflow_error("decimal overflow");
+}
+}  // namespace
+
+decimal::decimal() : m_value(0), m_scale(0), m_exact(true) {}
+
+decimal::decimal(const std::string &str) : m_value(0), m_scale(0), m_exact(true) {
+    parse(str.data(), str.size());
+}
+
+decimal::decimal(const char *str, size_t length) : m_value(0), m_scale(0), m_exact(true) {
+    parse(str, length);
+}
+
+decimal::decimal(s64 unscaled, u8 scale) : m_value(unscaled), m_scale(scale), m_exact(scale <= max_scale) {
+    if (!m_exact)
+        throw std::out_of_range("decimal scale out of range");
+}
+
+void decimal::parse(const char *str, size_t length) {
+    // nothing to parse, stays zero
+    if (!length)
+        return;
+
+    size_t i = 0;
+    bool negative = false;
+
+    if (i < length && (str[i] == '-' || str[i] == '+'))
+        negative = str[i++] == '-';
+
+    u64 mag = 0;
+    u32 digits = 0, scale = 0;
+    bool point = false, exact = true;
+
+    for (; i < length && exact; ++i) {
+        const char c = str[i];
+
+        if (c == '.' && !point)
+            point = true;
+        else if (c >= '0' && c <= '9') {
+            const u32 digit = static_cast<u32>(c - '0');
+            exact = mag <= (g_max_magnitude + 1 - digit) / 10;
+
+            mag = mag * 10 + digit;
+            ++digits;
+            scale += point ? 1 : 0;
+        } else
+            exact = false;
+    }
+
+    if (exact && digits > 0 && scale <= max_scale && from_magnitude(mag, negative, m_value)) {
+        m_scale = static_cast<u8>(scale);
+        m_exact = true;
+        return;
+    }
+
+    // not representable, keep as text
+    m_value = 0;
+    m_scale = 0;
+    m_exact = false;
+    m_text.assign(str, length);
+}
+
+size_t decimal::format(char *buffer) const {
+    check_exact();
+
+    // digits in reverse order, padded to have at least one integral digit
+    char digits[max_scale + 21];
+    size_t count = 0;
+
+    u64 mag = magnitude(m_value);
+    do {
+        digits[count++] = static_cast<char>('0' + mag % 10);
+        mag /= 10;
+    } while (mag);
+
+    while (count < static_cast<size_t>(m_scale) + 1) digits[count++] = '0';
+
+    size_t length = 0;
+    if (m_value < 0)
+        buffer[length++] = '-';
+
+    while (count > m_scale) buffer[length++] = digits[--count];
+
+    if (m_scale) {
+        buffer[length++] = '.';
+        while (count) buffer[length++] = digits[--count];
+    }
+
+    return length;
+}
+
+std::string decimal::str() const {
+    if (!m_exact)
+        return m_text;
+
+    char buffer[max_length];
+    return std::string(buffer, format(buffer));
+}
+
+f32 decimal::float32() const {
+    if (!m_exact)
+        return string_cast<f32>(m_text);
+
+    // correctly rounded conversion from the exact text
+    char buffer[max_length + 1];
+    buffer[format(buffer)] = '\0';
+    return strtof(buffer, nullptr);
+}
+
+f64 decimal::double64() const {
+    if (!m_exact)
+        return string_cast<f64>(m_text);
+
+    char buffer[max_length + 1];
+    buffer[format(buffer)] = '\0';
+    return strtod(buffer, nullptr);
+}
+
+bool decimal::is_exact() const {
+    return m_exact;
+}
+
+s64 decimal::unscaled() const {
+    return m_value;
+}
+
+u8 decimal::scale() const {
+    return m_scale;
+}
+
+decimal decimal::rescale(u8 scale) const {
+    check_exact();
+
+    if (scale >= m_scale) {
+        s64 value;
+        if (!scale_up(m_value, scale - m_scale, value))
+            throw_overflow();
+
+        return decimal(value, scale);
+    }
+
+    const u32 digits = m_scale - scale;
+    if (digits > g_max_pow10)
+        return decimal(0, scale);
+
+    // round half away from zero
+    const u64 divisor = g_pow10[digits];
+    const u64 mag = magnitude(m_value);
+    u64 quotient = mag / divisor;
+    const u64 remainder = mag % divisor;
+
+    if (remainder >= divisor - remainder)
+        ++quotient;
+
+    s64 value;
+    if (!from_magnitude(quotient, m_value < 0, value))
+        throw_overflow();
+
+    return decimal(value, scale);
+}
+
+int decimal::compare(const decimal &other) const {
+    check_exact();
+    other.check_exact();
+
+    s64 a = m_value, b = other.m_value;
+
+    // a value that overflows when scaled up is larger in magnitude than the other one
+    if (m_scale < other.m_scale && !scale_up(m_value, other.m_scale - m_scale, a))
+        return m_value < 0 ? -1 : 1;
+    if (other.m_scale < m_scale && !scale_up(other.m_value, m_scale - other.m_scale, b))
+        return other.m_value < 0 ? 1 : -1;
+
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+decimal decimal::operator-() const {
+    check_exact();
+
+    if (m_value == std::numeric_limits<s64>::min())
+        throw_overflow();
+
+    return decimal(-m_value, m_scale);
+}
+
+decimal decimal::operator+(const decimal &other) const {
+    check_exact();
+    other.check_exact();
+
+    const u8 scale = std::max(m_scale, other.m_scale);
+    s64 a, b, result;
+
+    if (!scale_up(m_value, scale - m_scale, a) || !scale_up(other.m_value, scale - other.m_scale, b) ||
+        !checked_add(a, b, result))
+        throw_overflow();
+
+    return decimal(result, scale);
+}
+
+decimal decimal::operator-(const decimal &other) const {
+    return *this + -other;
+}
+
+decimal decimal::operator*(const decimal &other) const {
+    check_exact();
+    other.check_exact();
+
+    s64 result;
+    if (!checked_multiply(m_value, other.m_value, result))
+        throw_overflow();
+
+    const u32 scale = static_cast<u32>(m_scale) + other.m_scale;
+    if (scale <= max_scale)
+        return decimal(result, static_cast<u8>(scale));
+
+    // drop the excess fractional digits
+    decimal product(result, 0);
+    product.m_scale = static_cast<u8>(scale - max_scale);
+    product = product.rescale(0);
+    product.m_scale = max_scale;
+    return product;
+}
+
+decimal &decimal::operator+=(const decimal &other) {
+    return *this = *this + other;
+}
+
+decimal &decimal::operator-=(const decimal &other) {
+    return *this = *this - other;
+}
+
+decimal &decimal::operator*=(const decimal &other) {
+    return *this = *this * other;
+}
+
+bool decimal::operator==(const decimal &other) const {
+    return compare(other) == 0;
+}
+
+bool decimal::operator!=(const decimal &other) const {
+    return compare(other) != 0;
+}
+
+bool decimal::operator<(const decimal &other) const {
+    return compare(other) < 0;
+}
+
+bool decimal::operator<=(const decimal &other) const {
+    return compare(other) <= 0;
+}
+
+bool decimal::operator>(const decimal &other) const {
+    return compare(other) > 0;
+}
+
+bool decimal::operator>=(const decimal &other) const {
+    return compare(other) >= 0;
+}
+
+void decimal::check_exact() const {
+    if (!m_exact)
+        throw std::domain_error("decimal is not exact: " + m_text);
+}
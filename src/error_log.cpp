@@ -0,0 +1,118 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mysql.h>
+#include <mariadb++/error_log.hpp>
+#include <mariadb++/tracing.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "private.hpp"
+
+using namespace mariadb;
+using namespace mariadb::error_log;
+
+namespace {
+// guards the sink below
+std::mutex g_lock;
+// sink receiving records, nullptr if there is none
+std::shared_ptr<sink> g_sink;
+// indicates whether a sink is set, checked without the lock
+std::atomic<bool> g_active(false);
+// maximum records per second, 0 for no limit
+std::atomic<u32> g_limit(0);
+// second the current window of the rate limit started
+std::atomic<u64> g_window(0);
+// records passed in the current window
+std::atomic<u32> g_passed(0);
+// records dropped since the last passed one
+std::atomic<u64> g_suppressed(0);
+
+u64 current_second() {
+    using namespace std::chrono;
+    return static_cast<u64>(duration_cast<seconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+//
+// Counts a record against the rate limit, returns false if it has to be dropped
+//
+bool admit() {
+    const u32 limit = g_limit.load(std::memory_order_relaxed);
+    if (!limit)
+        return true;
+
+    // the first record of a new second opens its window
+    const u64 second = current_second();
+    u64 window = g_window.load(std::memory_order_relaxed);
+    if (window != second && g_window.compare_exchange_strong(window, second))
+        g_passed = 0;
+
+    if (g_passed.fetch_add(1, std::memory_order_relaxed) < limit)
+        return true;
+
+    g_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+}  // namespace
+
+void error_log::set_sink(const sink &s, u32 max_per_second) {
+    std::lock_guard<std::mutex> lock(g_lock);
+
+    g_sink = s ? std::make_shared<sink>(s) : nullptr;
+    g_limit = max_per_second;
+    g_suppressed = 0;
+    g_active = static_cast<bool>(g_sink);
+}
+
+sink error_log::stderr_sink() {
+    return [](const record &r) {
+        // format first, a single write keeps lines of concurrent errors apart
+        std::ostringstream line;
+        line << "MariaDB Error(" << r.error_no << "): " << r.message << " [connection " << r.connection_id
+             << ", fingerprint " << std::hex << r.fingerprint << std::dec << ", " << r.function << " in " << r.file
+             << ':' << r.line;
+
+        if (r.suppressed)
+            line << ", " << r.suppressed << " more suppressed";
+
+        line << "]\n";
+        std::cerr << line.str();
+    };
+}
+
+void error_log::report(u32 error_no, const std::string &message, u64 connection_id, const std::string &sql,
+                       const char *function, const char *file, u32 line) {
+    if (!g_active.load(std::memory_order_relaxed) || !admit())
+        return;
+
+    std::shared_ptr<sink> target;
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        target = g_sink;
+    }
+
+    if (!target)
+        return;
+
+    record r;
+    r.error_no = error_no;
+    r.message = message;
+    r.connection_id = connection_id;
+    r.fingerprint = sql.empty() ? 0 : tracing::fingerprint(sql);
+    r.function = function;
+    r.file = file;
+    r.line = line;
+    r.suppressed = g_suppressed.exchange(0, std::memory_order_relaxed);
+
+    (*target)(r);
+}
@@ -34,3 +34,68 @@ exception::time::time(u8 hour, u8 minute, u8 second, u16 millisecond) throw() :
 
     m_error = oss.str();
 }
+
+//
+// Error categories
+//
+error_category::type error_category::classify(u32 error_no) throw() {
+    switch (error_no) {
+        case 0:
+            return none;
+
+        // can't connect, server gone away, lost connection, connection killed
+        case 2002:
+        case 2003:
+        case 2006:
+        case 2013:
+        case 2055:
+        case 1927:
+            return connection_lost;
+
+        case 1213:
+            return deadlock;
+
+        case 1205:
+            return lock_wait_timeout;
+
+        // duplicate key, duplicate entry, duplicate entry with key name
+        case 1022:
+        case 1062:
+        case 1586:
+            return duplicate_key;
+
+        // parse error, syntax error
+        case 1064:
+        case 1149:
+            return syntax;
+
+        // query interrupted, max_statement_time exceeded, max_execution_time exceeded
+        case 1317:
+        case 1969:
+        case 3024:
+            return timeout;
+
+        // server shutdown in progress, normal shutdown, shutdown complete, forcing close
+        case 1053:
+        case 1077:
+        case 1079:
+        case 1080:
+            return server_shutdown;
+
+        default:
+            return other;
+    }
+}
+
+bool error_category::transient(type category) throw() {
+    switch (category) {
+        case connection_lost:
+        case deadlock:
+        case lock_wait_timeout:
+        case server_shutdown:
+            return true;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,91 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include "instrument.hpp"
+
+using namespace mariadb;
+using namespace mariadb::instrument;
+
+std::atomic<const observer_list *> instrument::g_observers(nullptr);
+
+namespace {
+// serializes changes of the observer list
+std::mutex g_observers_lock;
+// all lists ever installed, a scope may still read a replaced one
+std::vector<std::unique_ptr<observer_list>> g_observer_lists;
+
+int uncaught_exceptions() {
+#if __cplusplus >= 201703L
+    return std::uncaught_exceptions();
+#else
+    return std::uncaught_exception() ? 1 : 0;
+#endif
+}
+
+void install(observer_list &&observers) {
+    if (observers.empty()) {
+        g_observers = nullptr;
+        return;
+    }
+
+    g_observer_lists.emplace_back(new observer_list(std::move(observers)));
+    g_observers.store(g_observer_lists.back().get(), std::memory_order_release);
+}
+}  // namespace
+
+void instrument::add_observer(observer *o) {
+    std::lock_guard<std::mutex> lock(g_observers_lock);
+    const observer_list *current = g_observers.load();
+
+    observer_list observers = current ? *current : observer_list();
+    if (std::find(observers.begin(), observers.end(), o) == observers.end())
+        observers.push_back(o);
+
+    install(std::move(observers));
+}
+
+void instrument::remove_observer(observer *o) {
+    std::lock_guard<std::mutex> lock(g_observers_lock);
+    const observer_list *current = g_observers.load();
+
+    if (!current)
+        return;
+
+    observer_list observers = *current;
+    observers.erase(std::remove(observers.begin(), observers.end(), o), observers.end());
+    install(std::move(observers));
+}
+
+void scope::begin(operation::type op, const last_error *source, const char *sql, size_t sql_length) {
+    m_source = source;
+    m_event.operation = op;
+    m_event.sql = sql;
+    m_event.sql_length = sql_length;
+    m_event.start = now();
+    m_event.duration = 0;
+    m_event.error = 0;
+    m_event.rows = 0;
+    m_event.bytes = 0;
+    m_exceptions = uncaught_exceptions();
+
+    for (observer *o : *m_observers) o->start(m_event);
+}
+
+void scope::finish() {
+    m_event.duration = now() - m_event.start;
+
+    // the error macros set the last error before throwing
+    if (uncaught_exceptions() > m_exceptions)
+        m_event.error = m_source && m_source->error_no() ? m_source->error_no() : ~0u;
+
+    for (observer *o : *m_observers) o->end(m_event);
+}
@@ -0,0 +1,114 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_INSTRUMENT_HPP_
+#define _MARIADB_INSTRUMENT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <vector>
+#include <mariadb++/last_error.hpp>
+#include <mariadb++/tracing.hpp>
+
+namespace mariadb {
+namespace instrument {
+//
+// Describes one instrumented operation
+//
+typedef tracing::span event;
+
+//
+// Receives instrumented operations. Observers are called on the thread running the operation
+// and must not throw
+//
+class observer {
+public:
+    virtual ~observer() = default;
+
+    virtual void start(const event &e) = 0;
+    virtual void end(const event &e) = 0;
+};
+
+typedef std::vector<observer *> observer_list;
+
+//
+// Installed observers, nullptr while there are none. Lists are immutable and never freed, so a
+// loaded list stays valid
+//
+extern std::atomic<const observer_list *> g_observers;
+
+//
+// Install or remove an observer, an observer is installed at most once
+//
+void add_observer(observer *o);
+void remove_observer(observer *o);
+
+//
+// Monotonic time in nanoseconds
+//
+inline u64 now() {
+    using namespace std::chrono;
+    return static_cast<u64>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+//
+// Instruments the operation running while the scope lives. Costs a single load and branch while
+// no observer is installed. Leaving the scope by exception reports the last error of source
+//
+class scope {
+public:
+    scope(operation::type op, const last_error *source, const char *sql = nullptr, size_t sql_length = 0)
+        : m_observers(g_observers.load(std::memory_order_acquire)) {
+        if (m_observers)
+            begin(op, source, sql, sql_length);
+    }
+
+    ~scope() {
+        if (m_observers)
+            finish();
+    }
+
+    //
+    // Indicates whether the operation is observed, results only need to be gathered if it is
+    //
+    bool active() const {
+        return m_observers != nullptr;
+    }
+
+    void rows(u64 rows) {
+        m_event.rows = rows;
+    }
+
+    void bytes(u64 bytes) {
+        m_event.bytes = bytes;
+    }
+
+    //
+    // Reports an error of an operation which fails without exception
+    //
+    void error(u32 error_no) {
+        m_event.error = error_no ? error_no : ~0u;
+    }
+
+private:
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+    void begin(operation::type op, const last_error *source, const char *sql, size_t sql_length);
+    void finish();
+
+    const observer_list *m_observers;
+    const last_error *m_source;
+    event m_event;
+    int m_exceptions;
+};
+}  // namespace instrument
+}  // namespace mariadb
+
+#endif
@@ -26,3 +26,11 @@ u32 last_error::error_no() const {
 const std::string &last_error::error() const {
     return m_last_error;
 }
+
+const std::string &last_error::sqlstate() const {
+    return m_last_sqlstate;
+}
+
+error_category::type last_error::category() const {
+    return error_category::classify(m_last_error_no);
+}
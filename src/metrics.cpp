@@ -0,0 +1,397 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/metrics.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <locale>
+#include <mutex>
+#include <sstream>
+
+#include "instrument.hpp"
+
+using namespace mariadb;
+using namespace mariadb::metrics;
+
+namespace {
+// values are exact up to this bucket, above each power of two has its own sub-buckets
+const u32 g_sub_buckets = 1u << histogram::sub_bucket_bits;
+// highest bit with buckets of its own, larger values end up in the last bucket
+const u32 g_max_bit = histogram::bucket_count / g_sub_buckets + histogram::sub_bucket_bits - 2;
+
+u32 highest_bit(u64 value) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    u32 bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+//
+// Metrics of one operation recorded by one thread. Only the owning thread writes, relaxed atomics
+// allow reading them from others
+//
+struct operation_recorder {
+    std::atomic<u64> m_calls{0};
+    std::atomic<u64> m_errors{0};
+    std::atomic<u64> m_rows{0};
+    std::atomic<u64> m_bytes{0};
+    std::atomic<u64> m_sum{0};
+    std::atomic<u64> m_max{0};
+    std::atomic<u64> m_buckets[histogram::bucket_count];
+
+    operation_recorder() {
+        for (std::atomic<u64> &b : m_buckets) b.store(0, std::memory_order_relaxed);
+    }
+
+    void record(const instrument::event &e) {
+        m_calls.fetch_add(1, std::memory_order_relaxed);
+        m_rows.fetch_add(e.rows, std::memory_order_relaxed);
+        m_bytes.fetch_add(e.bytes, std::memory_order_relaxed);
+        m_sum.fetch_add(e.duration, std::memory_order_relaxed);
+        m_buckets[histogram::bucket_index(e.duration)].fetch_add(1, std::memory_order_relaxed);
+
+        if (e.error)
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+
+        if (e.duration > m_max.load(std::memory_order_relaxed))
+            m_max.store(e.duration, std::memory_order_relaxed);
+    }
+
+    void collect(operation_metrics &m) const {
+        m.calls += m_calls.load(std::memory_order_relaxed);
+        m.errors += m_errors.load(std::memory_order_relaxed);
+        m.rows += m_rows.load(std::memory_order_relaxed);
+        m.bytes += m_bytes.load(std::memory_order_relaxed);
+
+        std::vector<u64> buckets(histogram::bucket_count);
+        for (u32 i = 0; i < histogram::bucket_count; ++i) buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+
+        m.latency.merge(
+            histogram(buckets, m_sum.load(std::memory_order_relaxed), m_max.load(std::memory_order_relaxed)));
+    }
+
+    void clear() {
+        m_calls = 0;
+        m_errors = 0;
+        m_rows = 0;
+        m_bytes = 0;
+        m_sum = 0;
+        m_max = 0;
+        for (std::atomic<u64> &b : m_buckets) b.store(0, std::memory_order_relaxed);
+    }
+};
+
+struct recorder {
+    operation_recorder m_operations[operation::count];
+    // guards the error counts below, only contended while a snapshot is taken
+    std::mutex m_lock;
+    // failed operations by error number
+    std::map<u32, u64> m_errors;
+
+    void record_error(u32 error) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        ++m_errors[error];
+    }
+
+    void collect_errors(std::map<u32, u64> &errors) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (const std::pair<const u32, u64> &e : m_errors) errors[e.first] += e.second;
+    }
+
+    void clear_errors() {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_errors.clear();
+    }
+};
+
+// guards the registry below
+std::mutex g_lock;
+// recorders of running threads
+std::vector<recorder *> g_recorders;
+// metrics of threads which ended
+snapshot g_retired;
+
+//
+// Registers the recorder of a thread while it runs
+//
+struct thread_recorder {
+    recorder *m_recorder;
+
+    thread_recorder() : m_recorder(new recorder()) {
+        std::lock_guard<std::mutex> lock(g_lock);
+        g_recorders.push_back(m_recorder);
+    }
+
+    ~thread_recorder() {
+        std::lock_guard<std::mutex> lock(g_lock);
+        g_recorders.erase(std::find(g_recorders.begin(), g_recorders.end(), m_recorder));
+
+        for (u32 op = 0; op < operation::count; ++op)
+            m_recorder->m_operations[op].collect(g_retired.operations[op]);
+        m_recorder->collect_errors(g_retired.errors);
+
+        delete m_recorder;
+    }
+};
+
+class metrics_observer : public instrument::observer {
+public:
+    void start(const instrument::event &) override {}
+
+    void end(const instrument::event &e) override {
+        static thread_local thread_recorder local;
+        local.m_recorder->m_operations[e.operation].record(e);
+
+        if (e.error)
+            local.m_recorder->record_error(e.error);
+    }
+};
+
+metrics_observer g_observer;
+std::atomic<bool> g_enabled(false);
+
+//
+// Formats nanoseconds as exact seconds without floating point, trailing zeros are left out
+//
+std::string seconds(u64 ns) {
+    char fraction[16];
+    snprintf(fraction, sizeof(fraction), "%09u", static_cast<u32>(ns % 1000000000));
+
+    size_t digits = 9;
+    while (digits && fraction[digits - 1] == '0') --digits;
+
+    std::string text = std::to_string(ns / 1000000000);
+    if (digits)
+        text += '.' + std::string(fraction, digits);
+
+    return text;
+}
+}  // namespace
+
+//
+// Histogram
+//
+histogram::histogram() : m_buckets(bucket_count), m_count(0), m_sum(0), m_max(0) {}
+
+histogram::histogram(const std::vector<u64> &buckets, u64 sum, u64 max)
+    : m_buckets(buckets), m_count(0), m_sum(sum), m_max(max) {
+    m_buckets.resize(bucket_count);
+    for (u64 count : m_buckets) m_count += count;
+}
+
+void histogram::record(u64 value, u64 count) {
+    m_buckets[bucket_index(value)] += count;
+    m_count += count;
+    m_sum += value * count;
+    m_max = std::max(m_max, value);
+}
+
+void histogram::merge(const histogram &other) {
+    for (u32 i = 0; i < bucket_count; ++i) m_buckets[i] += other.m_buckets[i];
+
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max(m_max, other.m_max);
+}
+
+u64 histogram::count() const {
+    return m_count;
+}
+
+u64 histogram::sum() const {
+    return m_sum;
+}
+
+u64 histogram::max() const {
+    return m_max;
+}
+
+u64 histogram::percentile(f64 percent) const {
+    if (!m_count)
+        return 0;
+
+    // rank of the value at the percentile, at least the first value
+    const f64 fraction = std::min(std::max(percent, 0.0), 100.0) / 100.0;
+    const u64 rank = std::max<u64>(1, static_cast<u64>(fraction * m_count + 0.5));
+
+    u64 seen = 0;
+    for (u32 i = 0; i < bucket_count; ++i) {
+        seen += m_buckets[i];
+
+        if (seen >= rank)
+            return std::min(bucket_upper_bound(i), m_max);
+    }
+
+    return m_max;
+}
+
+u64 histogram::bucket(u32 index) const {
+    return m_buckets.at(index);
+}
+
+u32 histogram::bucket_index(u64 value) {
+    if (value < g_sub_buckets)
+        return static_cast<u32>(value);
+
+    const u32 bit = highest_bit(value);
+    if (bit > g_max_bit)
+        return bucket_count - 1;
+
+    const u32 shift = bit - sub_bucket_bits;
+    return (shift + 1) * g_sub_buckets + static_cast<u32>((value >> shift) & (g_sub_buckets - 1));
+}
+
+u64 histogram::bucket_upper_bound(u32 index) {
+    if (index < g_sub_buckets)
+        return index;
+
+    const u32 shift = index / g_sub_buckets - 1;
+    const u64 lower = static_cast<u64>(g_sub_buckets + index % g_sub_buckets) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+//
+// Recording
+//
+void metrics::enable() {
+    if (!g_enabled.exchange(true))
+        instrument::add_observer(&g_observer);
+}
+
+void metrics::disable() {
+    if (g_enabled.exchange(false))
+        instrument::remove_observer(&g_observer);
+}
+
+bool metrics::enabled() {
+    return g_enabled;
+}
+
+snapshot metrics::get_snapshot() {
+    std::lock_guard<std::mutex> lock(g_lock);
+    snapshot result = g_retired;
+
+    for (recorder *r : g_recorders) {
+        for (u32 op = 0; op < operation::count; ++op) r->m_operations[op].collect(result.operations[op]);
+        r->collect_errors(result.errors);
+    }
+
+    return result;
+}
+
+void metrics::reset() {
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_retired = snapshot();
+
+    for (recorder *r : g_recorders) {
+        for (operation_recorder &op : r->m_operations) op.clear();
+        r->clear_errors();
+    }
+}
+
+//
+// Export
+//
+const char *metrics::operation_name(operation::type op) {
+    switch (op) {
+        case operation::connect:
+            return "connect";
+        case operation::query:
+            return "query";
+        case operation::execute:
+            return "execute";
+        case operation::insert:
+            return "insert";
+        case operation::prepare:
+            return "prepare";
+        case operation::statement_query:
+            return "statement_query";
+        case operation::statement_execute:
+            return "statement_execute";
+        case operation::statement_insert:
+            return "statement_insert";
+        case operation::fetch:
+            return "fetch";
+        case operation::pool_wait:
+            return "pool_wait";
+        default:
+            return "unknown";
+    }
+}
+
+void metrics::write_prometheus(std::ostream &stream, const snapshot &s, const std::string &prefix) {
+    // common bucket bounds of exported histograms in nanoseconds, each is exported as the closest
+    // bucket edge below, so no bucket straddles an exported bound
+    static const u64 bounds[] = {100000,     250000,     500000,     1000000,     2500000,     5000000,
+                                 10000000,   25000000,   50000000,   100000000,   250000000,   500000000,
+                                 1000000000, 2500000000, 5000000000, 10000000000, 30000000000, 60000000000};
+
+    struct counter {
+        const char *m_name;
+        const char *m_help;
+        u64 operation_metrics::*m_value;
+    };
+
+    static const counter counters[] = {
+        {"_operations_total", "Number of operations", &operation_metrics::calls},
+        {"_operation_errors_total", "Number of failed operations", &operation_metrics::errors},
+        {"_operation_rows_total", "Rows returned or affected by operations", &operation_metrics::rows},
+        {"_operation_bytes_total", "Bytes returned by operations", &operation_metrics::bytes}};
+
+    // numbers are formatted independently of the flags and locale of the target stream
+    std::ostringstream os;
+    os.imbue(std::locale::classic());
+
+    for (const counter &c : counters) {
+        os << "# HELP " << prefix << c.m_name << ' ' << c.m_help << '\n';
+        os << "# TYPE " << prefix << c.m_name << " counter\n";
+
+        for (u32 op = 0; op < operation::count; ++op)
+            os << prefix << c.m_name << "{operation=\"" << operation_name(static_cast<operation::type>(op)) << "\"} "
+               << s.operations[op].*c.m_value << '\n';
+    }
+
+    const std::string duration = prefix + "_operation_duration_seconds";
+    os << "# HELP " << duration << " Duration of operations\n";
+    os << "# TYPE " << duration << " histogram\n";
+
+    for (u32 op = 0; op < operation::count; ++op) {
+        const std::string label = std::string("operation=\"") + operation_name(static_cast<operation::type>(op)) + '"';
+        const histogram &h = s.operations[op].latency;
+
+        u64 cumulative = 0;
+        u32 index = 0;
+        for (u64 bound : bounds) {
+            // collect all buckets below the bound, the upper bound of the last one is the edge
+            for (; index < histogram::bucket_count && histogram::bucket_upper_bound(index) <= bound; ++index)
+                cumulative += h.bucket(index);
+
+            const u64 edge = histogram::bucket_upper_bound(index - 1);
+            os << duration << "_bucket{" << label << ",le=\"" << seconds(edge) << "\"} " << cumulative << '\n';
+        }
+
+        os << duration << "_bucket{" << label << ",le=\"+Inf\"} " << h.count() << '\n';
+        os << duration << "_sum{" << label << "} " << seconds(h.sum()) << '\n';
+        os << duration << "_count{" << label << "} " << h.count() << '\n';
+    }
+
+    const std::string errors = prefix + "_errors_total";
+    os << "# HELP " << errors << " Number of failed operations by error number\n";
+    os << "# TYPE " << errors << " counter\n";
+
+    for (const std::pair<const u32, u64> &error : s.errors)
+        os << errors << "{errno=\"" << error.first << "\"} " << error.second << '\n';
+
+    const std::string text = os.str();
+    stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
@@ -12,25 +12,90 @@
 #define _MARIADB_PRIVATE_HPP_
 
 #include <mariadb++/exceptions.hpp>
+#include <mariadb++/expected.hpp>
+#include <mariadb++/time.hpp>
+#include <mariadb++/time_span.hpp>
+#include <chrono>
 #include <ctime>
 
 namespace mariadb {
+namespace error_log {
+//
+// Passes an error to the sink, if one is set and the rate limit allows it
+//
+void report(u32 error_no, const std::string &message, u64 connection_id, const std::string &sql, const char *function,
+            const char *file, u32 line);
+}  // namespace error_log
+
+//
+// Fills the error of a non-throwing call
+//
+inline void set_error_info(error_info &error, u32 error_no, const std::string &message, const std::string &sqlstate,
+                           exception_type::type thrown) {
+    error.error_no = error_no;
+    error.message = message;
+    error.sqlstate = sqlstate;
+    error.category =
+        thrown == exception_type::timeout ? error_category::timeout : error_category::classify(error_no);
+    error.thrown = thrown;
+}
+
+//
+// Integer division rounding towards negative infinity
+//
+inline s64 floor_div(s64 value, s64 divisor) {
+    return value / divisor - (value % divisor != 0 && (value < 0) != (divisor < 0));
+}
+
+//
+// Splits a signed number of milliseconds into a time_span
+//
+inline time_span time_span_from_ms(s64 ms) {
+    const bool negative = ms < 0;
+    const u64 total = negative ? 0 - static_cast<u64>(ms) : static_cast<u64>(ms);
+
+    return time_span(static_cast<u32>(total / 86400000), static_cast<u8>(total / 3600000 % 24),
+                     static_cast<u8>(total / 60000 % 60), static_cast<u8>(total / 1000 % 60),
+                     static_cast<u16>(total % 1000), negative);
+}
+
+//
+// Converts a signed SQL TIME value, which may exceed a day, to a duration keeping microseconds
+//
+std::chrono::microseconds duration_from_mysql_time(const MYSQL_TIME &t);
+
+//
+// Converts a duration to a signed SQL TIME value, keeping microseconds
+//
+MYSQL_TIME mysql_time_from_duration(const std::chrono::microseconds &duration);
+
+//
+// Parses a signed SQL TIME value in text format [-]h[hh]:mm:ss[.ffffff], throws on invalid input
+//
+std::chrono::microseconds duration_from_string(const char *str, size_t length);
+
+//
+// Gets the current number of microseconds since the epoch in UTC, does not consult the timezone
+//
+inline s64 realtime_microseconds() {
 #if _WIN32
-inline int localtime_safe(struct tm *_tm, const time_t *_time) {
-    return localtime_s(_tm, _time);
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<s64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
 }
 
-inline int gmtime_safe(struct tm *_tm, const time_t *_time) {
-    return gmtime_s(_tm, _time);
+#if _WIN32
+inline int localtime_safe(struct tm *_tm, const time_t *_time) {
+    return localtime_s(_tm, _time);
 }
 #else
 inline int localtime_safe(struct tm *_tm, const time_t *_time) {
     return localtime_r(_time, _tm) ? 0 : -1;
 }
-
-inline int gmtime_safe(struct tm *_tm, const time_t *_time) {
-    return gmtime_r(_time, _tm) ? 0 : -1;
-}
 #endif
 }  // namespace mariadb
 #if _WIN32
@@ -62,38 +127,141 @@ inline int mysql_option_safe(MYSQL *mysql, const mysql_option option, const char
     } while (0)
 
 #define MARIADB_ERROR_QUIET(error, error_id, error_desc) MARIADB_THROW(error, error_id, error_desc)
-#define MARIADB_ERROR_VERBOSE(error, error_id, error_desc)                                                        \
-    do {                                                                                                          \
-        std::cerr << "MariaDB Error(" << (error_id) << "): " << (error_desc) << "\nIn function: " << __FUNCTION__ \
-                  << "\nIn file " << __FILE__ << "\nOn line " << __LINE__ << '\n';                                \
-        MARIADB_ERROR_QUIET(error, error_id, error_desc);                                                         \
-    } while (0)
 
+//
+// Reports the error to the error log with the server thread id of the connection and the failing
+// SQL, if known
+//
 #if MARIADB_QUIET
-#define MARIADB_ERROR MARIADB_ERROR_QUIET
+#define MARIADB_REPORT(error_id, error_desc, connection_id, sql) \
+    do {                                                         \
+        (void)(connection_id);                                   \
+    } while (0)
 #else
-#define MARIADB_ERROR MARIADB_ERROR_VERBOSE
+#define MARIADB_REPORT(error_id, error_desc, connection_id, sql)                                                \
+    mariadb::error_log::report((error_id), (error_desc), (connection_id), (sql), __FUNCTION__, __FILE__, __LINE__)
 #endif
 
-#define MARIADB_CONN_ERROR(conn)                                             \
-    do {                                                                     \
-        m_last_error_no = mysql_errno(conn);                                 \
-        m_last_error = mysql_error(conn);                                    \
-        MARIADB_ERROR(exception::connection, m_last_error_no, m_last_error); \
+//
+// Reports the error, then throws it with its SQLSTATE
+//
+#define MARIADB_ERROR_CONTEXT(error, error_id, error_desc, sqlstate, connection_id, sql) \
+    do {                                                                                 \
+        MARIADB_REPORT(error_id, error_desc, connection_id, sql);                        \
+        MARIADB_THROW(error, error_id, error_desc, sqlstate);                            \
+    } while (0)
+
+#define MARIADB_ERROR(error, error_id, error_desc) \
+    MARIADB_ERROR_CONTEXT(error, error_id, error_desc, std::string(), 0, std::string())
+
+//
+// Stores the last error of the connection or statement in last_error
+//
+#define MARIADB_CONN_LAST_ERROR(conn)           \
+    do {                                        \
+        m_last_error_no = mysql_errno(conn);    \
+        m_last_error = mysql_error(conn);       \
+        m_last_sqlstate = mysql_sqlstate(conn); \
+    } while (0)
+#define MARIADB_STMT_LAST_ERROR(stmt)                \
+    do {                                             \
+        m_last_error_no = mysql_stmt_errno(stmt);    \
+        m_last_error = mysql_stmt_error(stmt);       \
+        m_last_sqlstate = mysql_stmt_sqlstate(stmt); \
+    } while (0)
+
+#define MARIADB_CONN_ERROR(conn)                                                                     \
+    do {                                                                                             \
+        MARIADB_CONN_LAST_ERROR(conn);                                                               \
+        MARIADB_ERROR_CONTEXT(exception::connection, m_last_error_no, m_last_error, m_last_sqlstate, \
+                              mysql_thread_id(conn), std::string());                                 \
+    } while (0)
+#define MARIADB_CONN_CLOSE_ERROR(conn)                                                                              \
+    do {                                                                                                            \
+        MARIADB_CONN_LAST_ERROR(conn);                                                                              \
+        const u64 connection_id = mysql_thread_id(conn);                                                            \
+        disconnect();                                                                                               \
+        MARIADB_ERROR_CONTEXT(exception::connection, m_last_error_no, m_last_error, m_last_sqlstate, connection_id, \
+                              std::string());                                                                       \
     } while (0)
-#define MARIADB_CONN_CLOSE_ERROR(conn)                                       \
-    do {                                                                     \
-        m_last_error_no = mysql_errno(conn);                                 \
-        m_last_error = mysql_error(conn);                                    \
-        disconnect();                                                        \
-        MARIADB_ERROR(exception::connection, m_last_error_no, m_last_error); \
+
+//
+// Like MARIADB_CONN_ERROR, but throws exception::timeout if the watchdog guard interrupted the call
+//
+#define MARIADB_CONN_GUARD_ERROR(conn, guard, sql)                                                    \
+    do {                                                                                              \
+        MARIADB_CONN_LAST_ERROR(conn);                                                                \
+        if ((guard).disarm())                                                                         \
+            MARIADB_ERROR_CONTEXT(exception::timeout, m_last_error_no, m_last_error, m_last_sqlstate, \
+                                  mysql_thread_id(conn), sql);                                        \
+        MARIADB_ERROR_CONTEXT(exception::connection, m_last_error_no, m_last_error, m_last_sqlstate,  \
+                              mysql_thread_id(conn), sql);                                            \
+    } while (0)
+
+#define MARIADB_STMT_ERROR(stmt) MARIADB_STMT_QUERY_ERROR(stmt, 0, std::string())
+
+//
+// Like MARIADB_STMT_ERROR, reporting the server thread id of the connection and the SQL of the statement
+//
+#define MARIADB_STMT_QUERY_ERROR(stmt, connection_id, sql)                                                         \
+    do {                                                                                                           \
+        MARIADB_STMT_LAST_ERROR(stmt);                                                                             \
+        MARIADB_ERROR_CONTEXT(exception::statement, m_last_error_no, m_last_error, m_last_sqlstate, connection_id, \
+                              sql);                                                                                \
+    } while (0)
+
+#define MARIADB_STMT_GUARD_ERROR(stmt, guard, connection_id, sql)                                                    \
+    do {                                                                                                             \
+        MARIADB_STMT_LAST_ERROR(stmt);                                                                               \
+        if ((guard).disarm())                                                                                        \
+            MARIADB_ERROR_CONTEXT(exception::timeout, m_last_error_no, m_last_error, m_last_sqlstate, connection_id, \
+                                  sql);                                                                              \
+        MARIADB_ERROR_CONTEXT(exception::statement, m_last_error_no, m_last_error, m_last_sqlstate, connection_id,   \
+                              sql);                                                                                  \
+    } while (0)
+
+//
+// Variants of the macros above for the implementation of throwing and non-throwing calls: if error
+// is given, they fill it, report the error to the error log and the instrument scope and return
+// false instead of throwing
+//
+#define MARIADB_CONN_GUARD_FAIL(conn, guard, scope, sql, error)                                         \
+    do {                                                                                                \
+        if (error) {                                                                                    \
+            MARIADB_CONN_LAST_ERROR(conn);                                                              \
+            set_error_info(*(error), m_last_error_no, m_last_error, m_last_sqlstate,                    \
+                           (guard).disarm() ? exception_type::timeout : exception_type::connection);    \
+            MARIADB_REPORT(m_last_error_no, m_last_error, mysql_thread_id(conn), sql);                  \
+            (scope).error(m_last_error_no);                                                             \
+            return false;                                                                               \
+        }                                                                                               \
+        MARIADB_CONN_GUARD_ERROR(conn, guard, sql);                                                     \
+    } while (0)
+
+#define MARIADB_STMT_QUERY_FAIL(stmt, scope, connection_id, sql, error)                      \
+    do {                                                                                     \
+        if (error) {                                                                         \
+            MARIADB_STMT_LAST_ERROR(stmt);                                                   \
+            set_error_info(*(error), m_last_error_no, m_last_error, m_last_sqlstate,         \
+                           exception_type::statement);                                       \
+            MARIADB_REPORT(m_last_error_no, m_last_error, connection_id, sql);               \
+            (scope).error(m_last_error_no);                                                  \
+            return false;                                                                    \
+        }                                                                                    \
+        MARIADB_STMT_QUERY_ERROR(stmt, connection_id, sql);                                  \
     } while (0)
 
-#define MARIADB_STMT_ERROR(stmt)                                            \
-    do {                                                                    \
-        m_last_error_no = mysql_stmt_errno(stmt);                           \
-        m_last_error = mysql_stmt_error(stmt);                              \
-        MARIADB_ERROR(exception::statement, m_last_error_no, m_last_error); \
+#define MARIADB_STMT_GUARD_FAIL(stmt, guard, scope, connection_id, sql, error)                          \
+    do {                                                                                                \
+        if (error) {                                                                                    \
+            MARIADB_STMT_LAST_ERROR(stmt);                                                              \
+            set_error_info(*(error), m_last_error_no, m_last_error, m_last_sqlstate,                    \
+                           (guard).disarm() ? exception_type::timeout : exception_type::statement);     \
+            MARIADB_REPORT(m_last_error_no, m_last_error, connection_id, sql);                          \
+            (scope).error(m_last_error_no);                                                             \
+            return false;                                                                               \
+        }                                                                                               \
+        MARIADB_STMT_GUARD_ERROR(stmt, guard, connection_id, sql);                                      \
     } while (0)
 
 #endif
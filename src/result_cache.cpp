@@ -0,0 +1,180 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iterator>
+#include <mariadb++/result_cache.hpp>
+#include "result_store.hpp"
+
+using namespace mariadb;
+
+result_cache::result_cache(u64 max_size, u32 default_ttl)
+    : m_size(0), m_max_size(max_size), m_default_ttl(default_ttl), m_hits(0), m_misses(0) {}
+
+result_cache_ref result_cache::create(u64 max_size, u32 default_ttl) {
+    return result_cache_ref(new result_cache(max_size, default_ttl));
+}
+
+result_set_ref result_cache::query(const connection_ref &conn, const std::string &query, const tags_t &tags,
+                                   u32 ttl_ms) {
+    // the same SQL reads different data on other servers, accounts or schemas. Text protocol,
+    // statements without parameters run the same SQL with the binary protocol
+    const std::string key = 'T' + conn->cache_scope() + query;
+
+    result_set_ref rs = lookup(key);
+    if (rs)
+        return rs;
+
+    return store(key, conn->query(query), tags, ttl_ms);
+}
+
+result_set_ref result_cache::query(const statement_ref &stmt, const tags_t &tags, u32 ttl_ms) {
+    const std::string key = stmt->cache_key();
+
+    result_set_ref rs = lookup(key);
+    if (rs)
+        return rs;
+
+    return store(key, stmt->query(), tags, ttl_ms);
+}
+
+result_set_ref result_cache::lookup(const std::string &key) {
+    result_store_ref found;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+
+        if (it == m_entries.end()) {
+            ++m_misses;
+            return result_set_ref();
+        }
+
+        if (it->second->m_expires && it->second->m_expiry <= clock::now()) {
+            erase(it->second);
+            ++m_misses;
+            return result_set_ref();
+        }
+
+        // move to front as most recently used
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        found = it->second->m_store;
+        ++m_hits;
+    }
+
+    return result_set_ref(new result_set(found));
+}
+
+result_set_ref result_cache::store(const std::string &key, const result_set_ref &rs, const tags_t &tags,
+                                   u32 ttl_ms) {
+    if (!rs)
+        return rs;
+
+    // detach outside of the lock, this reads the whole result
+    result_store_ref detached = rs->make_store();
+    const u64 size = detached->size() + key.size();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const u32 ttl = ttl_ms == default_ttl_ms ? m_default_ttl : ttl_ms;
+
+        if (size <= m_max_size) {
+            // a concurrent miss might have stored the same key already
+            auto existing = m_entries.find(key);
+            if (existing != m_entries.end())
+                erase(existing->second);
+
+            m_lru.push_front(entry{key, tags, detached, size, clock::now() + std::chrono::milliseconds(ttl), ttl != 0});
+            m_entries[key] = m_lru.begin();
+            for (const std::string &tag : tags) m_tags.emplace(tag, m_lru.begin());
+
+            // evict least recently used entries
+            m_size += size;
+            while (m_size > m_max_size) erase(std::prev(m_lru.end()));
+        }
+    }
+
+    return result_set_ref(new result_set(detached));
+}
+
+void result_cache::erase(lru_t::iterator it) {
+    for (const std::string &tag : it->m_tags) {
+        auto range = m_tags.equal_range(tag);
+
+        for (auto tagged = range.first; tagged != range.second; ++tagged) {
+            if (tagged->second == it) {
+                m_tags.erase(tagged);
+                break;
+            }
+        }
+    }
+
+    m_entries.erase(it->m_key);
+    m_size -= it->m_size;
+    m_lru.erase(it);
+}
+
+void result_cache::invalidate(const std::string &tag) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // erase() removes the tag index entries as well, so always restart the lookup
+    auto tagged = m_tags.find(tag);
+    while (tagged != m_tags.end()) {
+        erase(tagged->second);
+        tagged = m_tags.find(tag);
+    }
+}
+
+void result_cache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_tags.clear();
+    m_entries.clear();
+    m_lru.clear();
+    m_size = 0;
+}
+
+u32 result_cache::entry_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<u32>(m_entries.size());
+}
+
+u64 result_cache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+u64 result_cache::max_size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_max_size;
+}
+
+void result_cache::set_max_size(u64 max_size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_size = max_size;
+
+    while (m_size > m_max_size) erase(std::prev(m_lru.end()));
+}
+
+u32 result_cache::default_ttl() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_default_ttl;
+}
+
+void result_cache::set_default_ttl(u32 ttl_ms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_default_ttl = ttl_ms;
+}
+
+u64 result_cache::hits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+u64 result_cache::misses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
@@ -14,19 +14,30 @@
 #include <mariadb++/result_set.hpp>
 #include <mariadb++/conversion_helper.hpp>
 #include <mariadb++/bind.hpp>
+#include <mariadb++/blob_stream.hpp>
+#include "instrument.hpp"
 #include "private.hpp"
+#include "result_store.hpp"
 
 using namespace mariadb;
 
-result_set::result_set(connection *conn)
-    : m_result_set((conn->account()->store_result() ? mysql_store_result : mysql_use_result)(conn->m_mysql)),
+namespace {
+// number of bytes fetched at once when streaming columns
+const size_t g_blob_chunk_size = 64 * 1024;
+}  // namespace
+
+result_set::result_set(MYSQL_RES *result)
+    : m_result_set(result),
       m_fields(nullptr),
       m_row(nullptr),
       m_raw_binds(nullptr),
       m_stmt_data(nullptr),
       m_lengths(nullptr),
+      m_store_row(0),
       m_field_count(0),
-      m_was_fetched(false) {
+      m_was_fetched(false),
+      m_binary(false),
+      m_stream_threshold(0) {
     if (m_result_set) {
         m_field_count = mysql_num_fields(m_result_set);
         m_fields = mysql_fetch_fields(m_result_set);
@@ -42,33 +53,60 @@ result_set::result_set(connection *conn, const statement_data_ref &stmt_data)
       m_raw_binds(nullptr),
       m_stmt_data(stmt_data),
       m_lengths(nullptr),
+      m_store_row(0),
       m_field_count(0),
-      m_was_fetched(false) {
-    int max_length = 1;
-    mysql_stmt_attr_set(stmt_data->m_statement, STMT_ATTR_UPDATE_MAX_LENGTH, &max_length);
-
-    if (conn->account()->store_result() && mysql_stmt_store_result(stmt_data->m_statement))
-        MARIADB_STMT_ERROR(stmt_data->m_statement);
-    else {
-        m_field_count = mysql_stmt_field_count(stmt_data->m_statement);
-        m_result_set = mysql_stmt_result_metadata(stmt_data->m_statement);
-
-        if (m_field_count > 0) {
-            m_fields = mysql_fetch_fields(m_result_set);
-            m_raw_binds = new MYSQL_BIND[m_field_count];
-            m_row = new char *[m_field_count];
-
-            for (u32 i = 0; i < m_field_count; ++i) {
-                m_indexes[m_fields[i].name] = i;
-                m_binds.emplace_back(new bind(&m_raw_binds[i], &m_fields[i]));
-                m_row[i] = m_binds[i]->buffer();
-            }
+      m_was_fetched(false),
+      m_binary(true),
+      m_stream_threshold(conn->account()->stream_threshold()) {
+    m_field_count = mysql_stmt_field_count(stmt_data->m_statement);
+    m_result_set = mysql_stmt_result_metadata(stmt_data->m_statement);
+
+    if (m_field_count > 0) {
+        m_fields = mysql_fetch_fields(m_result_set);
+        m_raw_binds = new MYSQL_BIND[m_field_count];
+        m_row = new char *[m_field_count];
+
+        // all column buffers come from one allocation, max_length is only known for stored results.
+        // columns exceeding the stream threshold are read on demand
+        std::vector<unsigned long> lengths(m_field_count);
+        size_t buffer_size = 0;
+        for (u32 i = 0; i < m_field_count; ++i) {
+            if (!m_stream_threshold || m_fields[i].max_length <= m_stream_threshold)
+                lengths[i] = m_fields[i].max_length;
+
+            buffer_size += lengths[i];
+        }
+        m_buffers.reserve(buffer_size);
 
-            mysql_stmt_bind_result(stmt_data->m_statement, m_raw_binds);
+        for (u32 i = 0; i < m_field_count; ++i) {
+            m_indexes[m_fields[i].name] = i;
+            m_binds.emplace_back(new bind(&m_raw_binds[i], &m_fields[i], m_buffers, lengths[i]));
+            m_row[i] = m_binds[i]->buffer();
         }
+
+        mysql_stmt_bind_result(stmt_data->m_statement, m_raw_binds);
     }
 }
 
+result_set::result_set(const result_store_ref &store)
+    : m_result_set(nullptr),
+      m_fields(store->m_fields.data()),
+      m_row(nullptr),
+      m_raw_binds(nullptr),
+      m_stmt_data(nullptr),
+      m_lengths(nullptr),
+      m_store(store),
+      m_store_row(0),
+      m_store_cells(store->m_field_count),
+      m_store_lengths(store->m_field_count),
+      m_field_count(store->m_field_count),
+      m_was_fetched(false),
+      m_binary(store->m_binary),
+      m_stream_threshold(0) {
+    m_row = m_store_cells.data();
+    m_lengths = m_store_lengths.data();
+}
+
 statement_data::~statement_data() {
     delete[] m_raw_binds;
 
@@ -90,16 +128,118 @@ result_set::~result_set() {
 }
 
 bool result_set::fetch_truncated() {
+    bool grown = false;
     for (u32 i = 0; i < m_field_count; ++i) {
         if (m_binds[i]->m_error) {
+            // left truncated, read on demand
+            if (m_stream_threshold && m_binds[i]->length() > m_stream_threshold) {
+                m_binds[i]->m_deferred = true;
+                continue;
+            }
+
             if (!m_binds[i]->resize())
                 return false;
             m_row[i] = m_binds[i]->buffer();
             if (mysql_stmt_fetch_column(m_stmt_data->m_statement, m_binds[i]->m_bind, i, 0))
                 return false;
+
+            grown = true;
         }
     }
-    return true;
+
+    // the statement keeps copies of the binds, without binding again the following rows would
+    // still be fetched into the old buffers and truncated again
+    return !grown || !mysql_stmt_bind_result(m_stmt_data->m_statement, m_raw_binds);
+}
+
+void result_set::load_column(u32 index) const {
+    if (!m_stmt_data || !m_binds[index]->m_deferred)
+        return;
+
+    // the buffer may have grown for an earlier row, so the flag and not its capacity tells whether
+    // the value of this row was read
+    bind &b = *m_binds[index];
+    if (!b.resize() || mysql_stmt_fetch_column(m_stmt_data->m_statement, b.m_bind, index, 0))
+        MARIADB_ERROR(exception::statement, mysql_stmt_errno(m_stmt_data->m_statement),
+                      mysql_stmt_error(m_stmt_data->m_statement));
+
+    b.m_deferred = false;
+    m_row[index] = b.buffer();
+}
+
+result_store_ref result_set::make_store() {
+    // nothing was read yet, the existing store can be shared as it is immutable
+    if (m_store && m_store_row == 0)
+        return m_store;
+
+    std::shared_ptr<result_store> store(new result_store());
+    store->m_binary = m_binary;
+    store->m_field_count = m_field_count;
+    store->m_fields.assign(m_fields, m_fields + m_field_count);
+    store->m_names.resize(m_field_count);
+
+    // field descriptions must not point into the original result
+    static char empty[] = "";
+    for (u32 i = 0; i < m_field_count; ++i) {
+        MYSQL_FIELD &field = store->m_fields[i];
+        store->m_names[i] = field.name;
+        store->m_indexes[store->m_names[i]] = i;
+
+        field.name = const_cast<char *>(store->m_names[i].c_str());
+        field.org_name = field.table = field.org_table = field.db = field.catalog = field.def = empty;
+    }
+
+    // the current row is part of the copy, if there is one
+    bool has_row = m_was_fetched || next();
+    while (has_row) {
+        const u64 first_cell = store->m_row_count * m_field_count;
+        store->m_nulls.resize((first_cell + m_field_count + 7) / 8);
+
+        for (u32 i = 0; i < m_field_count; ++i) {
+            const u64 cell = first_cell + i;
+            store->m_offsets.push_back(store->m_arena.size());
+
+            if (_get_body_is_null(i))
+                store->m_nulls[cell / 8] |= static_cast<u8>(1u << (cell % 8));
+            else {
+                load_column(i);
+                store->m_arena.insert(store->m_arena.end(), m_row[i], m_row[i] + cell_size(i));
+            }
+        }
+
+        ++store->m_row_count;
+        has_row = next();
+    }
+
+    store->m_offsets.push_back(store->m_arena.size());
+    store->m_arena.shrink_to_fit();
+    store->m_offsets.shrink_to_fit();
+    store->m_nulls.shrink_to_fit();
+    return store;
+}
+
+result_set_ref result_set::materialize() {
+    return result_set_ref(new result_set(make_store()));
+}
+
+result_set_ref result_store::open(const result_store_ref &store) {
+    return result_set_ref(new result_set(store));
+}
+
+bool result_set::is_detached() const {
+    return !!m_store;
+}
+
+unsigned long result_set::cell_size(u32 index) const {
+    // text protocol and detached stores know their lengths
+    if (!m_stmt_data)
+        return m_lengths[index];
+
+    const bind &b = *m_binds[index];
+    if (b.m_bind->buffer == &b.m_time)
+        return sizeof(MYSQL_TIME);
+
+    return b.m_bind->buffer == &b.m_unsigned64 ? sizeof(u64) : b.length();
 }
 
 u32 result_set::column_count() const {
@@ -179,9 +319,10 @@ const std::string result_set::column_name(u32 index) {
 }
 
 u32 result_set::column_index(const std::string &name) const {
-    const map_indexes_t::const_iterator i = m_indexes.find(name);
+    const map_indexes_t &indexes = m_store ? m_store->m_indexes : m_indexes;
+    const map_indexes_t::const_iterator i = indexes.find(name);
 
-    if (i == m_indexes.end())
+    if (i == indexes.end())
         return 0xffffffff;
 
     return i->second;
@@ -195,7 +336,9 @@ unsigned long result_set::column_size(u32 index) const {
 }
 
 bool result_set::set_row_index(u64 index) {
-    if (m_stmt_data)
+    if (m_store)
+        m_store_row = index;
+    else if (m_stmt_data)
         mysql_stmt_data_seek(m_stmt_data->m_statement, index);
     else
         mysql_data_seek(m_result_set, index);
@@ -203,24 +346,62 @@ bool result_set::set_row_index(u64 index) {
 }
 
 bool result_set::next() {
+    if (m_store) {
+        if (m_store_row >= m_store->m_row_count)
+            return (m_was_fetched = false);
+
+        const u64 first_cell = m_store_row * m_field_count;
+        for (u32 i = 0; i < m_field_count; ++i) {
+            const u64 offset = m_store->m_offsets[first_cell + i];
+
+            m_store_lengths[i] = static_cast<unsigned long>(m_store->m_offsets[first_cell + i + 1] - offset);
+            m_store_cells[i] = m_store->is_null(m_store_row, i)
+                                   ? nullptr
+                                   : const_cast<char *>(m_store->m_arena.data() + offset);
+        }
+
+        ++m_store_row;
+        return (m_was_fetched = true);
+    }
+
     if (!m_result_set)
         return (m_was_fetched = false);
 
+    instrument::scope scope(operation::fetch, this);
+
     if (m_stmt_data) {
+        if (m_stream_threshold) {
+            for (const bind_ref &b : m_binds) b->m_deferred = false;
+        }
+
         int ret = mysql_stmt_fetch(m_stmt_data->m_statement);
         if (ret == MYSQL_DATA_TRUNCATED)
-            return (m_was_fetched = fetch_truncated());
-        return (m_was_fetched = !ret);
+            m_was_fetched = fetch_truncated();
+        else
+            m_was_fetched = !ret;
+    } else {
+        m_row = mysql_fetch_row(m_result_set);
+        m_lengths = mysql_fetch_lengths(m_result_set);
+
+        // make sure no access to results is possible until a result is successfully fetched
+        m_was_fetched = m_row != nullptr;
     }
 
-    m_row = mysql_fetch_row(m_result_set);
-    m_lengths = mysql_fetch_lengths(m_result_set);
+    if (scope.active() && m_was_fetched) {
+        u64 bytes = 0;
+        for (u32 i = 0; i < m_field_count; ++i) bytes += m_stmt_data ? m_binds[i]->length() : m_lengths[i];
 
-    // make sure no access to results is possible until a result is successfully fetched
-    return (m_was_fetched = m_row != nullptr);
+        scope.rows(1);
+        scope.bytes(bytes);
+    }
+
+    return m_was_fetched;
 }
 
 u64 result_set::row_index() const {
+    if (m_store)
+        return m_store_row ? m_store_row - 1 : 0;
+
     if (m_stmt_data)
         return reinterpret_cast<u64>(mysql_stmt_row_tell(m_stmt_data->m_statement));
 
@@ -228,6 +409,9 @@ u64 result_set::row_index() const {
 }
 
 u64 result_set::row_count() const {
+    if (m_store)
+        return m_store->m_row_count;
+
     if (m_stmt_data)
         return mysql_stmt_num_rows(m_stmt_data->m_statement);
 
@@ -239,8 +423,11 @@ void result_set::check_row_fetched() const {
         throw std::out_of_range("No row was fetched");
 }
 
-void result_set::check_type(u32 index, value::type requested) const {
-    value::type actual = column_type(index);
+namespace {
+//
+// Indicates whether a column of type actual can be read as type requested
+//
+bool type_matches(value::type requested, value::type actual) {
     bool type_error;
 
     // check requested type vs actual type.
@@ -293,8 +480,39 @@ void result_set::check_type(u32 index, value::type requested) const {
             type_error = false;
     }
 
-    if (type_error)
-        MARIADB_ERROR(exception::connection, 12, "type error: requested type " + std::to_string(requested) + " does not match actual type " + std::to_string(actual));
+    return !type_error;
+}
+
+std::string type_error_message(value::type requested, value::type actual) {
+    return "type error: requested type " + std::to_string(requested) + " does not match actual type " +
+           std::to_string(actual);
+}
+}  // namespace
+
+void result_set::check_type(u32 index, value::type requested) const {
+    const value::type actual = column_type(index);
+
+    if (!type_matches(requested, actual))
+        MARIADB_ERROR(exception::connection, 12, type_error_message(requested, actual));
+}
+
+bool result_set::check_column(u32 index, value::type requested, error_info &error) const {
+    if (!m_was_fetched) {
+        error.message = "No row was fetched";
+        error.thrown = exception_type::out_of_range;
+    } else if (index >= m_field_count) {
+        error.message = "Column index out of range";
+        error.thrown = exception_type::out_of_range;
+    } else if (!type_matches(requested, column_type(index))) {
+        error.error_no = 12;
+        error.message = type_error_message(requested, column_type(index));
+        error.thrown = exception_type::connection;
+    } else {
+        return true;
+    }
+
+    error.category = error_category::other;
+    return false;
 }
 
 MAKE_GETTER(blob, stream_ref, value::type::blob) {
@@ -303,119 +521,141 @@ MAKE_GETTER(blob, stream_ref, value::type::blob) {
     if (len == 0)
         return stream_ref();
 
-    auto *ss = new std::istringstream();
-    ss->rdbuf()->pubsetbuf(m_row[index], len);
-    return stream_ref(ss);
+    // columns left truncated are streamed in chunks straight from the statement
+    if (m_stmt_data && m_binds[index]->m_deferred)
+        return std::make_shared<column_stream>(m_stmt_data, index, m_binds[index]->m_bind->buffer_type, len,
+                                               g_blob_chunk_size);
+
+    return std::make_shared<memory_stream>(m_row[index], len, m_store);
 }
 
 MAKE_GETTER(data, data_ref, value::type::data) {
     size_t len = column_size(index);
+    if (len == 0)
+        return data_ref();
 
-    return len == 0 ? data_ref() : data_ref(new data<char>(m_row[index], len));
+    load_column(index);
+    return data_ref(new data<char>(m_row[index], len));
 }
 
 MAKE_GETTER(string, std::string, value::type::string) {
+    load_column(index);
     return std::string(m_row[index], column_size(index));
 }
 
 MAKE_GETTER(date, date_time, value::type::date) {
-    if (m_stmt_data)
-        return mariadb::date_time(m_binds[index]->m_time);
+    if (m_binary)
+        return mariadb::date_time(binary_value<MYSQL_TIME>(index));
 
     return date_time(std::string(m_row[index], column_size(index))).date();
 }
 
 MAKE_GETTER(date_time, date_time, value::type::date_time) {
-    if (m_stmt_data)
-        return mariadb::date_time(m_binds[index]->m_time);
+    if (m_binary)
+        return mariadb::date_time(binary_value<MYSQL_TIME>(index));
 
     return date_time(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(time, mariadb::time, value::type::time) {
-    if (m_stmt_data)
-        return mariadb::time(m_binds[index]->m_time);
+    if (m_binary)
+        return mariadb::time(binary_value<MYSQL_TIME>(index));
 
     return mariadb::time(std::string(m_row[index], column_size(index)));
 }
 
+MAKE_GETTER(time_point, std::chrono::system_clock::time_point, value::type::date_time) {
+    if (m_binary)
+        return mariadb::date_time(binary_value<MYSQL_TIME>(index)).time_point();
+
+    return date_time(std::string(m_row[index], column_size(index))).time_point();
+}
+
+MAKE_GETTER(duration, std::chrono::microseconds, value::type::time) {
+    if (m_binary)
+        return duration_from_mysql_time(binary_value<MYSQL_TIME>(index));
+
+    return duration_from_string(m_row[index], column_size(index));
+}
+
 MAKE_GETTER(decimal, decimal, value::type::decimal) {
-    return decimal(std::string(m_row[index], column_size(index)));
+    load_column(index);
+    return decimal(m_row[index], column_size(index));
 }
 
 MAKE_GETTER(boolean, bool, value::type::boolean) {
-    if (m_stmt_data)
-        return (m_binds[index]->m_uchar8[0] != 0);
+    if (m_binary)
+        return (binary_value<u8>(index) != 0);
 
     return string_cast<bool>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(unsigned8, u8, value::type::unsigned8) {
-    if (m_stmt_data)
-        return checked_cast<u8>(0x00000000000000ff & m_binds[index]->m_unsigned64);
+    if (m_binary)
+        return checked_cast<u8>(0x00000000000000ff & binary_value<u64>(index));
 
     return string_cast<u8>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(signed8, s8, value::type::signed8) {
-    if (m_stmt_data)
-        return checked_cast<s8>(0x00000000000000ff & m_binds[index]->m_signed64);
+    if (m_binary)
+        return checked_cast<s8>(0x00000000000000ff & binary_value<s64>(index));
 
     return string_cast<s8>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(unsigned16, u16, value::type::unsigned16) {
-    if (m_stmt_data)
-        return checked_cast<u16>(0x000000000000ffff & m_binds[index]->m_unsigned64);
+    if (m_binary)
+        return checked_cast<u16>(0x000000000000ffff & binary_value<u64>(index));
 
     return string_cast<u16>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(signed16, s16, value::type::signed16) {
-    if (m_stmt_data)
-        return checked_cast<s16>(0x000000000000ffff & m_binds[index]->m_signed64);
+    if (m_binary)
+        return checked_cast<s16>(0x000000000000ffff & binary_value<s64>(index));
 
     return string_cast<s16>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(unsigned32, u32, value::type::unsigned32) {
-    if (m_stmt_data)
-        return checked_cast<u32>(0x00000000ffffffff & m_binds[index]->m_unsigned64);
+    if (m_binary)
+        return checked_cast<u32>(0x00000000ffffffff & binary_value<u64>(index));
 
     return string_cast<u32>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(signed32, s32, value::type::signed32) {
-    if (m_stmt_data)
-        return m_binds[index]->m_signed32[0];
+    if (m_binary)
+        return binary_value<s32>(index);
 
     return string_cast<s32>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(unsigned64, u64, value::type::unsigned64) {
-    if (m_stmt_data)
-        return m_binds[index]->m_unsigned64;
+    if (m_binary)
+        return binary_value<u64>(index);
 
     return string_cast<u64>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(signed64, s64, value::type::signed64) {
-    if (m_stmt_data)
-        return m_binds[index]->m_signed64;
+    if (m_binary)
+        return binary_value<s64>(index);
 
     return string_cast<s64>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(float, f32, value::type::float32) {
-    if (m_stmt_data)
-        return m_binds[index]->m_float32[0];
+    if (m_binary)
+        return binary_value<f32>(index);
 
     return string_cast<f32>(std::string(m_row[index], column_size(index)));
 }
 
 MAKE_GETTER(double, f64, value::type::double64) {
-    if (m_stmt_data)
-        return checked_cast<f64>(m_binds[index]->m_double64);
+    if (m_binary)
+        return checked_cast<f64>(binary_value<f64>(index));
 
     return string_cast<f64>(std::string(m_row[index], column_size(index)));
 }
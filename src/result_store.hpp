@@ -0,0 +1,78 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_RESULT_STORE_HPP_
+#define _MARIADB_RESULT_STORE_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <mysql.h>
+#include <mariadb++/result_set.hpp>
+
+namespace mariadb {
+/*
+ * Detached, immutable copy of a result which no longer depends on a connection or statement.
+ * The cells of all rows are stored back to back in a single arena and addressed by per cell
+ * offsets, NULL cells are tracked in a bitmap.
+ *
+ * A shared_ptr is used to share the data between any number of result_sets reading from it.
+ */
+struct result_store {
+    result_store() = default;
+    result_store(const result_store &) = delete;
+    result_store &operator=(const result_store &) = delete;
+
+    /**
+     * Indicates whether the cell at row and column is NULL
+     */
+    bool is_null(u64 row, u32 column) const {
+        const u64 cell = row * m_field_count + column;
+        return (m_nulls[cell / 8] & (1u << (cell % 8))) != 0;
+    }
+
+    /**
+     * Creates a detached result_set reading from the given store, which may also be filled by hand,
+     * e.g. to feed synthetic rows to the getters without a server in benchmarks
+     *
+     * @param store Store to read from, the cells need to match the protocol given by its m_binary
+     * @return Detached result_set positioned before its first row
+     */
+    static result_set_ref open(const std::shared_ptr<const result_store> &store);
+
+    /**
+     * Gets the total number of bytes held by this store
+     */
+    u64 size() const {
+        return sizeof(result_store) + m_arena.capacity() + m_offsets.capacity() * sizeof(u64) + m_nulls.capacity() +
+               m_fields.capacity() * sizeof(MYSQL_FIELD);
+    }
+
+    // indicates if cells hold binary values as bound by prepared statements
+    bool m_binary = false;
+    // count of fields per row
+    u32 m_field_count = 0;
+    // count of rows
+    u64 m_row_count = 0;
+    // copied field descriptions, names point into m_names
+    std::vector<MYSQL_FIELD> m_fields;
+    // owned field names
+    std::vector<std::string> m_names;
+    // map caching column index by name
+    std::map<std::string, u32> m_indexes;
+    // contents of all cells
+    std::vector<char> m_arena;
+    // offset of every cell into the arena, followed by the end offset
+    std::vector<u64> m_offsets;
+    // one bit per cell, set if the cell is NULL
+    std::vector<u8> m_nulls;
+};
+
+}  // namespace mariadb
+
+#endif
@@ -0,0 +1,161 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/slow_log.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "instrument.hpp"
+
+using namespace mariadb;
+using namespace mariadb::slow_log;
+
+namespace {
+// guards the entries below
+std::mutex g_lock;
+// recorded entries by fingerprint
+std::unordered_map<u64, entry> g_entries;
+// maximum number of entries
+std::atomic<u32> g_capacity(100);
+// minimum duration of recorded executions in nanoseconds
+std::atomic<u64> g_threshold(0);
+std::atomic<bool> g_enabled(false);
+
+bool by_total_time(const entry &a, const entry &b) {
+    return a.total_time > b.total_time;
+}
+
+//
+// Records slow executions of SQL text
+//
+class slow_log_observer : public instrument::observer {
+public:
+    void start(const instrument::event &) override {}
+
+    void end(const instrument::event &e) override {
+        // fetches and connects have no SQL of their own
+        if (!e.sql || e.duration < g_threshold.load(std::memory_order_relaxed))
+            return;
+
+        switch (e.operation) {
+            case operation::query:
+            case operation::execute:
+            case operation::insert:
+            case operation::statement_query:
+            case operation::statement_execute:
+            case operation::statement_insert:
+                record(e);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+private:
+    void record(const instrument::event &e) {
+        const u64 fingerprint = e.fingerprint();
+        std::lock_guard<std::mutex> lock(g_lock);
+
+        std::unordered_map<u64, entry>::iterator it = g_entries.find(fingerprint);
+        if (it == g_entries.end()) {
+            if (g_entries.size() >= g_capacity.load(std::memory_order_relaxed) && !evict(e.duration))
+                return;
+
+            it = g_entries.emplace(fingerprint, entry()).first;
+            it->second.fingerprint = fingerprint;
+            it->second.sql = e.normalized();
+        }
+
+        entry &en = it->second;
+        en.count++;
+        en.rows += e.rows;
+        en.total_time += e.duration;
+        en.max_time = std::max(en.max_time, e.duration);
+
+        if (e.error)
+            en.errors++;
+    }
+
+    //
+    // Makes room for an execution of duration by dropping entries with less total time
+    //
+    bool evict(u64 duration) {
+        const u32 capacity = g_capacity.load(std::memory_order_relaxed);
+
+        while (!g_entries.empty() && g_entries.size() >= capacity) {
+            std::unordered_map<u64, entry>::iterator least = g_entries.begin();
+            for (std::unordered_map<u64, entry>::iterator it = g_entries.begin(); it != g_entries.end(); ++it) {
+                if (it->second.total_time < least->second.total_time)
+                    least = it;
+            }
+
+            if (least->second.total_time >= duration)
+                return false;
+
+            g_entries.erase(least);
+        }
+
+        return capacity > 0;
+    }
+};
+
+slow_log_observer g_observer;
+}  // namespace
+
+void slow_log::enable(u64 threshold_ms, u32 capacity) {
+    g_threshold = threshold_ms * 1000000;
+    g_capacity = capacity;
+
+    if (!g_enabled.exchange(true))
+        instrument::add_observer(&g_observer);
+}
+
+void slow_log::disable() {
+    if (g_enabled.exchange(false))
+        instrument::remove_observer(&g_observer);
+}
+
+bool slow_log::enabled() {
+    return g_enabled;
+}
+
+std::vector<entry> slow_log::get_top(u32 limit) {
+    std::vector<entry> result;
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        result.reserve(g_entries.size());
+
+        for (const std::pair<const u64, entry> &e : g_entries) result.push_back(e.second);
+    }
+
+    std::sort(result.begin(), result.end(), by_total_time);
+
+    if (limit && result.size() > limit)
+        result.resize(limit);
+
+    return result;
+}
+
+void slow_log::reset() {
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_entries.clear();
+}
+
+void slow_log::dump(std::ostream &os, u32 limit) {
+    os << "# total_ms count errors max_ms avg_ms rows fingerprint sql\n";
+
+    for (const entry &e : get_top(limit)) {
+        os << e.total_time / 1e6 << ' ' << e.count << ' ' << e.errors << ' ' << e.max_time / 1e6 << ' '
+           << e.total_time / 1e6 / e.count << ' ' << e.rows << ' ' << std::hex << e.fingerprint << std::dec << ' '
+           << e.sql << '\n';
+    }
+}
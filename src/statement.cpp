@@ -14,17 +14,21 @@
 #include <mariadb++/result_set.hpp>
 #include <mariadb++/statement.hpp>
 #include <mariadb++/bind.hpp>
+#include "instrument.hpp"
 #include "private.hpp"
+#include "watchdog.hpp"
 #include <cstdint>
 
 using namespace mariadb;
 
 statement::statement(connection *conn, const std::string &query)
-    : m_parent(conn), m_data(statement_data_ref(new statement_data(mysql_stmt_init(conn->m_mysql)))) {
+    : m_parent(conn), m_data(statement_data_ref(new statement_data(mysql_stmt_init(conn->m_mysql), query))) {
+    instrument::scope scope(operation::prepare, this, query.c_str(), query.size());
+
     if (!m_data->m_statement)
         MARIADB_CONN_ERROR(conn->m_mysql);
     else if (mysql_stmt_prepare(m_data->m_statement, query.c_str(), query.size()))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_QUERY_ERROR(m_data->m_statement, conn->thread_id(), query);
     else {
         m_data->m_bind_count = mysql_stmt_param_count(m_data->m_statement);
 
@@ -37,41 +41,141 @@ statement::statement(connection *conn, const std::string &query)
     }
 }
 
+std::string statement::cache_key() const {
+    // binary protocol, cells are encoded differently than for the same SQL run as text query
+    std::string key = 'B' + m_parent->cache_scope() + m_data->m_query;
+
+    // type and raw bytes of every parameter, NULL parameters have their own type
+    for (const bind_ref &bind : m_data->m_binds) {
+        const unsigned long length = bind->length();
+
+        key.push_back('\0');
+        key.push_back(static_cast<char>(bind->m_bind->buffer_type));
+        key.push_back(static_cast<char>(bind->m_bind->is_unsigned));
+        key.append(reinterpret_cast<const char *>(&length), sizeof(length));
+
+        if (bind->m_bind->buffer == &bind->m_time) {
+            // MYSQL_TIME contains padding, only append its members
+            const MYSQL_TIME &t = bind->m_time;
+            const unsigned long members[] = {t.year, t.month, t.day, t.hour, t.minute, t.second, t.second_part,
+                                             static_cast<unsigned long>(t.neg)};
+            key.append(reinterpret_cast<const char *>(members), sizeof(members));
+        } else if (bind->m_bind->buffer_type != MYSQL_TYPE_NULL)
+            key.append(bind->buffer(), length);
+    }
+
+    return key;
+}
+
 void statement::set_connection(connection_ref &connection) {
     m_connection = connection;
 }
 
 u64 statement::execute() {
+    u64 affected_rows = 0;
+    run_execute(affected_rows, nullptr);
+    return affected_rows;
+}
+
+u64 statement::insert() {
+    u64 id = 0;
+    run_insert(id, nullptr);
+    return id;
+}
+
+result_set_ref statement::query() {
+    result_set_ref rs;
+    run_query(rs, nullptr);
+    return rs;
+}
+
+expected<u64> statement::try_execute() {
+    u64 affected_rows = 0;
+    error_info error;
+
+    if (!run_execute(affected_rows, &error))
+        return error;
+
+    return affected_rows;
+}
+
+expected<u64> statement::try_insert() {
+    u64 id = 0;
+    error_info error;
+
+    if (!run_insert(id, &error))
+        return error;
+
+    return id;
+}
+
+expected<result_set_ref> statement::try_query() {
+    result_set_ref rs;
+    error_info error;
+
+    if (!run_query(rs, &error))
+        return error;
+
+    return rs;
+}
+
+bool statement::run_execute(u64 &affected_rows, error_info *error) {
+    instrument::scope scope(operation::statement_execute, this, m_data->m_query.c_str(), m_data->m_query.size());
+
     if (m_data->m_raw_binds && mysql_stmt_bind_param(m_data->m_statement, m_data->m_raw_binds))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_QUERY_FAIL(m_data->m_statement, scope, m_parent->thread_id(), m_data->m_query, error);
+
+    watchdog::guard guard(m_parent->m_account, m_parent->thread_id(), m_parent->m_query_timeout);
 
     if (mysql_stmt_execute(m_data->m_statement))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_GUARD_FAIL(m_data->m_statement, guard, scope, m_parent->thread_id(), m_data->m_query, error);
 
-    return mysql_stmt_affected_rows(m_data->m_statement);
+    affected_rows = mysql_stmt_affected_rows(m_data->m_statement);
+    scope.rows(affected_rows);
+    return true;
 }
 
-u64 statement::insert() {
+bool statement::run_insert(u64 &id, error_info *error) {
+    instrument::scope scope(operation::statement_insert, this, m_data->m_query.c_str(), m_data->m_query.size());
+
     if (m_data->m_raw_binds && mysql_stmt_bind_param(m_data->m_statement, m_data->m_raw_binds))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_QUERY_FAIL(m_data->m_statement, scope, m_parent->thread_id(), m_data->m_query, error);
+
+    watchdog::guard guard(m_parent->m_account, m_parent->thread_id(), m_parent->m_query_timeout);
 
     if (mysql_stmt_execute(m_data->m_statement))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_GUARD_FAIL(m_data->m_statement, guard, scope, m_parent->thread_id(), m_data->m_query, error);
 
-    return mysql_stmt_insert_id(m_data->m_statement);
+    scope.rows(mysql_stmt_affected_rows(m_data->m_statement));
+    id = mysql_stmt_insert_id(m_data->m_statement);
+    return true;
 }
 
-result_set_ref statement::query() {
-    result_set_ref rs;
+bool statement::run_query(result_set_ref &result, error_info *error) {
+    instrument::scope scope(operation::statement_query, this, m_data->m_query.c_str(), m_data->m_query.size());
 
     if (m_data->m_raw_binds && mysql_stmt_bind_param(m_data->m_statement, m_data->m_raw_binds))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_QUERY_FAIL(m_data->m_statement, scope, m_parent->thread_id(), m_data->m_query, error);
+
+    watchdog::guard guard(m_parent->m_account, m_parent->thread_id(), m_parent->m_query_timeout);
 
     if (mysql_stmt_execute(m_data->m_statement))
-        MARIADB_STMT_ERROR(m_data->m_statement);
+        MARIADB_STMT_GUARD_FAIL(m_data->m_statement, guard, scope, m_parent->thread_id(), m_data->m_query, error);
 
-    rs.reset(new result_set(m_parent, m_data));
-    return rs;
+    // storing the result is part of the call, an interrupted store fails like the execution. The
+    // buffers of the result set are sized by the max_length of the stored columns
+    if (m_parent->m_account->store_result()) {
+        int max_length = 1;
+        mysql_stmt_attr_set(m_data->m_statement, STMT_ATTR_UPDATE_MAX_LENGTH, &max_length);
+
+        if (mysql_stmt_store_result(m_data->m_statement))
+            MARIADB_STMT_GUARD_FAIL(m_data->m_statement, guard, scope, m_parent->thread_id(), m_data->m_query, error);
+
+        scope.rows(mysql_stmt_num_rows(m_data->m_statement));
+    }
+
+    result.reset(new result_set(m_parent, m_data));
+    return true;
 }
 
 MAKE_SETTER(blob, stream_ref) {
@@ -110,9 +214,26 @@ MAKE_SETTER(time, const mariadb::time &) {
     bind.set(MYSQL_TYPE_TIME);
 }
 
+MAKE_SETTER(time_point, const std::chrono::system_clock::time_point &) {
+    bind.m_time = date_time(value).mysql_time();
+    bind.set(MYSQL_TYPE_DATETIME);
+}
+
+MAKE_SETTER(duration, const std::chrono::microseconds &) {
+    bind.m_time = mysql_time_from_duration(value);
+    bind.set(MYSQL_TYPE_TIME);
+}
+
 MAKE_SETTER(decimal, const decimal &) {
-    std::string str = value.str();
-    bind.set(MYSQL_TYPE_STRING, str.c_str(), str.size());
+    if (!value.is_exact()) {
+        std::string str = value.str();
+        bind.set(MYSQL_TYPE_STRING, str.c_str(), str.size());
+        return;
+    }
+
+    // typical values are short enough to be kept inline by the bind
+    char buffer[decimal::max_length];
+    bind.set(MYSQL_TYPE_NEWDECIMAL, buffer, value.format(buffer));
 }
 
 MAKE_SETTER(string, const std::string &) {
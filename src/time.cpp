@@ -9,6 +9,8 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include <mysql.h>
+#include <algorithm>
+#include <cctype>
 #include <sstream>
 #include <mariadb++/exceptions.hpp>
 #include <mariadb++/date_time.hpp>
@@ -18,32 +20,35 @@
 #include <chrono>
 #include "private.hpp"
 
-#define MS_PER_SEC 1000
-#define MS_PER_MIN (MS_PER_SEC * 60)
-#define MS_PER_HOUR (MS_PER_MIN * 60)
-#define MS_PER_DAY (MS_PER_HOUR * 24)
+#define US_PER_MS 1000
+#define US_PER_SEC (US_PER_MS * 1000)
+#define US_PER_MIN (US_PER_SEC * 60)
+#define US_PER_HOUR (US_PER_MIN * 60ll)
+#define US_PER_DAY (US_PER_HOUR * 24)
 
 mariadb::time::time(u8 hour, u8 minute, u8 second, u16 millisecond) {
     set(hour, minute, second, millisecond);
 }
 
-mariadb::time::time(const time &t) {
-    set(t.hour(), t.minute(), t.second(), t.millisecond());
-}
+mariadb::time::time(const time &t)
+    : m_hour(t.m_hour), m_minute(t.m_minute), m_second(t.m_second), m_microsecond(t.m_microsecond) {}
 
 mariadb::time::time(const tm &t) {
     set(t.tm_hour, t.tm_min, t.tm_sec, 0);
 }
 
 mariadb::time::time(const time_t &t) {
-    tm ts;
-    localtime_safe(&ts, &t);
-
-    set(ts.tm_hour, ts.tm_min, ts.tm_sec, 0);
+    const s64 seconds = static_cast<s64>(t);
+    set_time_of_day((seconds - floor_div(seconds, 86400) * 86400) * US_PER_SEC);
 }
 
 mariadb::time::time(const MYSQL_TIME &t) {
-    set(t.hour, t.minute, t.second, t.second_part / 1000);
+    set(t.hour, t.minute, t.second, 0);
+    m_microsecond = static_cast<u32>(t.second_part);
+}
+
+mariadb::time::time(const std::chrono::microseconds &time_of_day) {
+    this->time_of_day(time_of_day);
 }
 
 mariadb::time::time(const std::string &t) {
@@ -69,14 +74,17 @@ int mariadb::time::compare(const time &t) const {
     if (second() > t.second())
         return 1;
 
-    if (millisecond() < t.millisecond())
+    if (microsecond() < t.microsecond())
         return -1;
 
-    return millisecond() == t.millisecond() ? 0 : 1;
+    return microsecond() == t.microsecond() ? 0 : 1;
 }
 
 mariadb::time &mariadb::time::operator=(const time &t) {
-    set(t.hour(), t.minute(), t.second(), t.millisecond());
+    m_hour = t.m_hour;
+    m_minute = t.m_minute;
+    m_second = t.m_second;
+    m_microsecond = t.m_microsecond;
     return *this;
 }
 
@@ -108,7 +116,7 @@ bool mariadb::time::set(u8 hour, u8 minute, u8 second, u16 millisecond) {
     m_hour = hour;
     m_minute = minute;
     m_second = second;
-    m_millisecond = millisecond;
+    m_microsecond = millisecond * static_cast<u32>(US_PER_MS);
     return true;
 }
 
@@ -151,90 +159,43 @@ mariadb::u8 mariadb::time::second(u8 second) {
 }
 
 mariadb::u16 mariadb::time::millisecond() const {
-    return m_millisecond;
+    return static_cast<u16>(m_microsecond / US_PER_MS);
 }
 
 mariadb::u16 mariadb::time::millisecond(u16 millisecond) {
     MARIADB_THROW_IF(millisecond > 999, exception::time, hour(), minute(), second(), millisecond);
 
-    m_millisecond = millisecond;
+    m_microsecond = millisecond * static_cast<u32>(US_PER_MS);
 
-    return m_millisecond;
+    return millisecond;
 }
 
-mariadb::time mariadb::time::add_hours(s32 hours) const {
-    mariadb::time tmp = *this;
-
-    if (hours == 0)
-        return tmp;
-
-    // hour overflow does not matter, as we dont care about days
-    hours = (hours + hour() + 24) % 24;
-    tmp.hour(hours);
-    return tmp;
+mariadb::u32 mariadb::time::microsecond() const {
+    return m_microsecond;
 }
 
-mariadb::time mariadb::time::add_minutes(s32 minutes) const {
-    mariadb::time tmp = *this;
+mariadb::u32 mariadb::time::microsecond(u32 microsecond) {
+    MARIADB_THROW_IF(microsecond > 999999, exception::time, hour(), minute(), second(), millisecond());
 
-    if (minutes == 0)
-        return tmp;
+    m_microsecond = microsecond;
 
-    s32 hours = minutes / 60;
-    minutes = (minutes % 60) + minute();
-
-    if (minutes >= 60)
-        ++hours;
-    else if (minutes < 0)
-        --hours;
+    return m_microsecond;
+}
 
-    if (hours != 0)
-        tmp = tmp.add_hours(hours);
+mariadb::time mariadb::time::add_hours(s32 hours) const {
+    return add(std::chrono::microseconds(static_cast<s64>(hours) * US_PER_HOUR));
+}
 
-    tmp.minute((minutes + 60) % 60);
-    return tmp;
+mariadb::time mariadb::time::add_minutes(s32 minutes) const {
+    return add(std::chrono::microseconds(static_cast<s64>(minutes) * US_PER_MIN));
 }
 
 mariadb::time mariadb::time::add_seconds(s32 seconds) const {
-    mariadb::time tmp = *this;
-
-    if (seconds == 0)
-        return tmp;
-
-    s32 minutes = seconds / 60;
-    seconds = (seconds % 60) + second();
-
-    if (seconds >= 60)
-        ++minutes;
-    else if (seconds < 0)
-        --minutes;
-
-    if (minutes != 0)
-        tmp = tmp.add_minutes(minutes);
-
-    tmp.second((seconds + 60) % 60);
-    return tmp;
+    return add(std::chrono::microseconds(static_cast<s64>(seconds) * US_PER_SEC));
 }
 
 mariadb::time mariadb::time::add_milliseconds(s32 milliseconds) const {
-    mariadb::time tmp = *this;
-
-    if (milliseconds == 0)
-        return tmp;
-
-    s32 seconds = milliseconds / 1000;
-    milliseconds = (milliseconds % 1000) + millisecond();
-
-    if (milliseconds > 999)
-        ++seconds;
-    else if (milliseconds < 0)
-        --seconds;
-
-    if (seconds != 0)
-        tmp = tmp.add_seconds(seconds);
-
-    tmp.millisecond((milliseconds + 1000) % 1000);
-    return tmp;
+    return add(std::chrono::microseconds(static_cast<s64>(milliseconds) * US_PER_MS));
 }
 
 mariadb::time mariadb::time::subtract(const time_span &dur) const {
@@ -247,64 +208,41 @@ mariadb::time mariadb::time::subtract(const time_span &dur) const {
 }
 
 mariadb::time mariadb::time::add(const time_span &dur) const {
-    // negate if needed
-    s32 negative = dur.negative() ? -1 : 1;
-    time tmp = *this;
-
-    tmp.add_hours(negative * dur.hours());
-    tmp.add_minutes(negative * dur.minutes());
-    tmp.add_seconds(negative * dur.seconds());
-    tmp.add_milliseconds(negative * dur.milliseconds());
+    const s64 ms = static_cast<s64>(dur.total_milliseconds());
+    return add(std::chrono::milliseconds(dur.negative() ? -ms : ms));
+}
+
+mariadb::time mariadb::time::add(const std::chrono::microseconds &dur) const {
+    // day overflow does not matter, as we dont care about days
+    mariadb::time tmp = *this;
+    tmp.time_of_day(time_of_day() + dur);
     return tmp;
 }
 
 mariadb::time_span mariadb::time::time_between(const time &t) const {
-    // equal
-    if (t == *this)
-        return time_span(0, 0, 0, 0, 0);
-
-    // recursive call with negation
-    if (t > *this) {
-        time_span dur = t.time_between(*this);
-        dur.negative(true);
-        return dur;
-    }
-
-    // calculate the ms representation of both
-    s64 ms = (hour() * MS_PER_HOUR) + (minute() * MS_PER_MIN) + (second() * MS_PER_SEC) + millisecond();
-    s64 t_ms = (t.hour() * MS_PER_HOUR) + (t.minute() * MS_PER_MIN) + (t.second() * MS_PER_SEC) + t.millisecond();
-    s64 total_ms = 0;
-
-    // subtract the lesser from greater // TODO: is this case ever reached since we have recusive
-    // call on t > this?
-    if (t_ms > ms)
-        total_ms = MS_PER_DAY - (t_ms - ms);
-    else
-        total_ms = ms - t_ms;
-
-    u32 hours = static_cast<u32>(total_ms / MS_PER_HOUR);
-    total_ms = total_ms % MS_PER_HOUR;
+    return time_span_from_ms((time_of_day() - t.time_of_day()).count() / US_PER_MS);
+}
 
-    u32 minutes = static_cast<u32>(total_ms / MS_PER_MIN);
-    total_ms = total_ms % MS_PER_MIN;
+std::chrono::microseconds mariadb::time::time_of_day() const {
+    return std::chrono::microseconds(hour() * US_PER_HOUR + minute() * static_cast<s64>(US_PER_MIN) +
+                                     second() * static_cast<s64>(US_PER_SEC) + m_microsecond);
+}
 
-    u32 seconds = static_cast<u32>(total_ms / MS_PER_SEC);
-    total_ms = total_ms % MS_PER_SEC;
+std::chrono::microseconds mariadb::time::time_of_day(const std::chrono::microseconds &time_of_day) {
+    const s64 us = time_of_day.count();
+    set_time_of_day(us - floor_div(us, US_PER_DAY) * US_PER_DAY);
+    return this->time_of_day();
+}
 
-    return time_span(0, hours, minutes, seconds, static_cast<u32>(total_ms), false);
+void mariadb::time::set_time_of_day(s64 us) {
+    m_hour = static_cast<u8>(us / US_PER_HOUR);
+    m_minute = static_cast<u8>(us / US_PER_MIN % 60);
+    m_second = static_cast<u8>(us / US_PER_SEC % 60);
+    m_microsecond = static_cast<u32>(us % US_PER_SEC);
 }
 
 time_t mariadb::time::mktime() const {
-    tm time_struct;
-
-    time_struct.tm_year = 1900;
-    time_struct.tm_mon = 0;
-    time_struct.tm_mday = 1;
-    time_struct.tm_hour = hour();
-    time_struct.tm_min = minute();
-    time_struct.tm_sec = second();
-
-    return ::mktime(&time_struct);
+    return static_cast<time_t>(hour() * 3600 + minute() * 60 + second());
 }
 
 MYSQL_TIME mariadb::time::mysql_time() const {
@@ -316,21 +254,18 @@ MYSQL_TIME mariadb::time::mysql_time() const {
     t.hour = hour();
     t.minute = minute();
     t.second = second();
-    t.second_part = millisecond() * 1000u;
+    t.second_part = microsecond();
     t.neg = false;
     t.time_type = MYSQL_TIMESTAMP_TIME;
     return t;
 }
 
 double mariadb::time::diff_time(const time &t) const {
-    time_t time_val = mktime();
-    time_t t_time_val = t.mktime();
-
-    return ::difftime(time_val, t_time_val);
+    return static_cast<double>((time_of_day() - t.time_of_day()).count()) / US_PER_SEC;
 }
 
 bool mariadb::time::is_valid() const {
-    return time::valid_time(hour(), minute(), second(), millisecond());
+    return time::valid_time(hour(), minute(), second(), 0) && microsecond() < US_PER_SEC;
 }
 
 bool mariadb::time::valid_time(u8 hour, u8 minute, u8 second, u16 millisecond) {
@@ -346,27 +281,29 @@ mariadb::time mariadb::time::now() {
     tm ts;
     localtime_safe(&ts, &local_time);
 
-    auto millis = duration_cast<milliseconds>(now.time_since_epoch()).count() % 1000;
-    return mariadb::time(ts).add_milliseconds(static_cast<s32>(millis));
+    mariadb::time result(ts);
+    result.m_microsecond = static_cast<u32>(duration_cast<microseconds>(now.time_since_epoch()).count() % US_PER_SEC);
+    return result;
 }
 
 mariadb::time mariadb::time::now_utc() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
+    mariadb::time result;
+    result.time_of_day(std::chrono::microseconds(realtime_microseconds()));
+    return result;
+}
 
-    time_t utc_time = system_clock::to_time_t(now);
+mariadb::time mariadb::time::from_local_time(const time_t &t) {
     tm ts;
-    gmtime_safe(&ts, &utc_time);
+    localtime_safe(&ts, &t);
 
-    auto millis = duration_cast<milliseconds>(now.time_since_epoch()).count() % 1000;
-    return mariadb::time(ts).add_milliseconds(static_cast<s32>(millis));
+    return mariadb::time(ts);
 }
 
 bool mariadb::time::set(const std::string &t) {
     std::stringstream stream(t);
 
     u8 h, m, s;
-    u16 s_h = 0, s_m = 0, s_s = 0, s_ms = 0;
+    u16 s_h = 0, s_m = 0, s_s = 0;
     char delim;
 
     // read formatted hours, check overflow before cast
@@ -387,9 +324,21 @@ bool mariadb::time::set(const std::string &t) {
                 if (stream.eof())
                     return set(h, m, s, 0);
 
-                // read formatted millis
-                if (stream >> delim && stream >> s_ms)
-                    return set(h, m, s, s_ms);
+                // read formatted fraction of a second, scaled by its number of digits as the
+                // server sends TIME(1) to TIME(6), digits beyond microseconds are ignored
+                u32 microsecond = 0, scale = US_PER_SEC, digits = 0;
+                if (stream >> delim) {
+                    for (; std::isdigit(stream.peek()); ++digits) {
+                        scale /= 10;
+                        microsecond += static_cast<u32>(stream.get() - '0') * scale;
+                    }
+                }
+
+                if (digits) {
+                    set(h, m, s, 0);
+                    m_microsecond = microsecond;
+                    return true;
+                }
             }
         }
     }
@@ -414,6 +363,71 @@ const std::string mariadb::time::str_time(bool with_millisecond) const {
     return stream.str();
 }
 
+std::chrono::microseconds mariadb::duration_from_mysql_time(const MYSQL_TIME &t) {
+    // clients differ in whether days of the binary protocol are folded into the hours
+    const s64 hours = static_cast<s64>(t.day) * 24 + t.hour;
+    const s64 us = hours * US_PER_HOUR + t.minute * static_cast<s64>(US_PER_MIN) +
+                   t.second * static_cast<s64>(US_PER_SEC) + static_cast<s64>(t.second_part);
+
+    return std::chrono::microseconds(t.neg ? -us : us);
+}
+
+MYSQL_TIME mariadb::mysql_time_from_duration(const std::chrono::microseconds &duration) {
+    const s64 count = duration.count();
+    const u64 us = count < 0 ? 0 - static_cast<u64>(count) : static_cast<u64>(count);
+    MYSQL_TIME t;
+
+    // split off whole days, the binary protocol carries the hours in a single byte
+    t.year = 0;
+    t.month = 0;
+    t.day = static_cast<unsigned int>(us / US_PER_DAY);
+    t.hour = static_cast<unsigned int>(us / US_PER_HOUR % 24);
+    t.minute = static_cast<unsigned int>(us / US_PER_MIN % 60);
+    t.second = static_cast<unsigned int>(us / US_PER_SEC % 60);
+    t.second_part = static_cast<unsigned long>(us % US_PER_SEC);
+    t.neg = count < 0;
+    t.time_type = MYSQL_TIMESTAMP_TIME;
+    return t;
+}
+
+std::chrono::microseconds mariadb::duration_from_string(const char *str, size_t length) {
+    const char *end = str + length;
+    const bool negative = str != end && *str == '-';
+    s64 fields[3] = {0, 0, 0};
+    s64 us = 0;
+
+    if (negative)
+        ++str;
+
+    // hours, minutes and seconds, each separated by a colon
+    for (size_t i = 0; i < 3; ++i) {
+        if (i && (str == end || *str++ != ':'))
+            throw std::invalid_argument("invalid time format");
+
+        const char *start = str;
+        for (; str != end && std::isdigit(static_cast<unsigned char>(*str)) && str - start < 8; ++str)
+            fields[i] = fields[i] * 10 + (*str - '0');
+
+        if (str == start)
+            throw std::invalid_argument("invalid time format");
+    }
+
+    // optional fraction of a second, digits beyond microseconds are ignored
+    if (str != end && *str == '.') {
+        s64 scale = US_PER_SEC;
+        for (++str; str != end && std::isdigit(static_cast<unsigned char>(*str)); ++str) {
+            scale /= 10;
+            us += (*str - '0') * scale;
+        }
+    }
+
+    if (str != end || fields[1] > 59 || fields[2] > 59)
+        throw std::invalid_argument("invalid time format");
+
+    us += fields[0] * US_PER_HOUR + fields[1] * US_PER_MIN + fields[2] * US_PER_SEC;
+    return std::chrono::microseconds(negative ? -us : us);
+}
+
 std::ostream &mariadb::operator<<(std::ostream &os, const time &t) {
     os << t.str_time(true);
     return os;
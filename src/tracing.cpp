@@ -0,0 +1,270 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/tracing.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "instrument.hpp"
+
+using namespace mariadb;
+using namespace mariadb::tracing;
+
+namespace {
+//
+// Forwards instrumented operations to the callbacks of a tracing observer
+//
+class dispatcher : public instrument::observer {
+public:
+    explicit dispatcher(tracing::observer *target) : m_target(target) {}
+
+    void start(const span &s) override {
+        switch (s.operation) {
+            case operation::query:
+            case operation::execute:
+            case operation::insert:
+                m_target->on_query_start(s);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void end(const span &s) override {
+        switch (s.operation) {
+            case operation::connect:
+                m_target->on_connect(s);
+                break;
+
+            case operation::query:
+            case operation::execute:
+            case operation::insert:
+                m_target->on_query_end(s);
+                break;
+
+            case operation::prepare:
+                m_target->on_prepare(s);
+                break;
+
+            case operation::statement_query:
+            case operation::statement_execute:
+            case operation::statement_insert:
+                m_target->on_execute(s);
+                break;
+
+            case operation::fetch:
+                m_target->on_fetch_batch(s);
+                break;
+
+            case operation::pool_wait:
+                m_target->on_pool_wait(s);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+private:
+    tracing::observer *m_target;
+};
+
+// guards the dispatchers below
+std::mutex g_lock;
+// dispatcher of every observer ever installed, kept as operations may still use them
+std::map<tracing::observer *, std::unique_ptr<dispatcher>> g_dispatchers;
+
+bool is_identifier(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+//
+// Skips a quoted literal starting at i, returns the index after it
+//
+size_t skip_quoted(const char *sql, size_t length, size_t i) {
+    const char quote = sql[i++];
+
+    while (i < length) {
+        if (sql[i] == '\\') {
+            i += 2;
+        } else if (sql[i] == quote) {
+            // doubled quotes escape themselves
+            if (i + 1 < length && sql[i + 1] == quote)
+                i += 2;
+            else
+                return i + 1;
+        } else {
+            ++i;
+        }
+    }
+
+    return length;
+}
+
+//
+// Skips a number starting at i, returns the index after it
+//
+size_t skip_number(const char *sql, size_t length, size_t i) {
+    if (sql[i] == '0' && i + 1 < length && (sql[i + 1] == 'x' || sql[i + 1] == 'X' || sql[i + 1] == 'b')) {
+        i += 2;
+        while (i < length && is_identifier(sql[i])) ++i;
+        return i;
+    }
+
+    while (i < length && (is_digit(sql[i]) || sql[i] == '.')) ++i;
+
+    // exponent
+    if (i < length && (sql[i] == 'e' || sql[i] == 'E')) {
+        size_t j = i + 1;
+        if (j < length && (sql[j] == '+' || sql[j] == '-'))
+            ++j;
+
+        if (j < length && is_digit(sql[j])) {
+            i = j;
+            while (i < length && is_digit(sql[i])) ++i;
+        }
+    }
+
+    return i;
+}
+
+//
+// Appends a placeholder, a list of placeholders collapses into one
+//
+void append_placeholder(std::string &result) {
+    const size_t size = result.size();
+
+    if (size >= 3 && result.compare(size - 3, 3, "?, ") == 0)
+        result.resize(size - 2);
+    else if (size >= 2 && result.compare(size - 2, 2, "?,") == 0)
+        result.resize(size - 1);
+    else
+        result += '?';
+}
+}  // namespace
+
+std::string span::normalized() const {
+    return sql ? normalize(sql, sql_length) : std::string();
+}
+
+u64 span::fingerprint() const {
+    return sql ? tracing::fingerprint(sql, sql_length) : 0;
+}
+
+void tracing::add_observer(observer *o) {
+    dispatcher *d;
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        std::unique_ptr<dispatcher> &entry = g_dispatchers[o];
+
+        if (!entry)
+            entry.reset(new dispatcher(o));
+
+        d = entry.get();
+    }
+
+    instrument::add_observer(d);
+}
+
+void tracing::remove_observer(observer *o) {
+    dispatcher *d;
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        std::map<tracing::observer *, std::unique_ptr<dispatcher>>::const_iterator it = g_dispatchers.find(o);
+
+        if (it == g_dispatchers.end())
+            return;
+
+        d = it->second.get();
+    }
+
+    instrument::remove_observer(d);
+}
+
+std::string tracing::normalize(const char *sql, size_t length) {
+    std::string result;
+    result.reserve(length);
+
+    size_t i = 0;
+    while (i < length) {
+        const char c = sql[i];
+
+        if (is_space(c)) {
+            // collapse whitespace, drop it at the start
+            while (i < length && is_space(sql[i])) ++i;
+
+            if (!result.empty() && result.back() != ' ')
+                result += ' ';
+        } else if (c == '\'' || c == '"') {
+            i = skip_quoted(sql, length, i);
+            append_placeholder(result);
+        } else if (c == '`') {
+            // quoted identifiers are kept
+            const size_t end = skip_quoted(sql, length, i);
+            result.append(sql + i, end - i);
+            i = end;
+        } else if (c == '/' && i + 1 < length && sql[i + 1] == '*') {
+            const size_t end = std::string(sql + i + 2, length - i - 2).find("*/");
+            i = end == std::string::npos ? length : i + 2 + end + 2;
+        } else if (c == '#' || (c == '-' && i + 2 < length && sql[i + 1] == '-' && is_space(sql[i + 2]))) {
+            while (i < length && sql[i] != '\n') ++i;
+        } else if ((c == 'x' || c == 'X' || c == 'b' || c == 'B') && i + 1 < length && sql[i + 1] == '\'' &&
+                   (result.empty() || !is_identifier(result.back()))) {
+            // hexadecimal and bit literals
+            i = skip_quoted(sql, length, i + 1);
+            append_placeholder(result);
+        } else if ((is_digit(c) || (c == '.' && i + 1 < length && is_digit(sql[i + 1]))) &&
+                   (result.empty() || !is_identifier(result.back()))) {
+            i = skip_number(sql, length, i);
+            append_placeholder(result);
+        } else if (is_identifier(c)) {
+            while (i < length && is_identifier(sql[i])) result += sql[i++];
+        } else {
+            result += c;
+            ++i;
+        }
+    }
+
+    // trailing whitespace and statement terminator do not matter
+    while (!result.empty() && (result.back() == ' ' || result.back() == ';')) result.pop_back();
+
+    return result;
+}
+
+std::string tracing::normalize(const std::string &sql) {
+    return normalize(sql.c_str(), sql.size());
+}
+
+u64 tracing::fingerprint(const char *sql, size_t length) {
+    const std::string normalized = normalize(sql, length);
+
+    // FNV-1a
+    u64 hash = 14695981039346656037ull;
+    for (char c : normalized) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+u64 tracing::fingerprint(const std::string &sql) {
+    return fingerprint(sql.c_str(), sql.size());
+}
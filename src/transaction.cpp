@@ -22,15 +22,22 @@ const char *g_isolation_level[] = {
     "SET TRANSACTION ISOLATION LEVEL SERIALIZABLE;",
 };
 
-const char *g_consistent_snapshot[] = {
-    "START TRANSACTION;",
-    "START TRANSACTION WITH CONSISTENT SNAPSHOT;",
+// indexed by consistent snapshot and read only
+const char *g_start_transaction[2][2] = {
+    {"START TRANSACTION;", "START TRANSACTION READ ONLY;"},
+    {"START TRANSACTION WITH CONSISTENT SNAPSHOT;", "START TRANSACTION WITH CONSISTENT SNAPSHOT, READ ONLY;"},
 };
 }  // namespace
 
-transaction::transaction(connection *conn, isolation::level level, bool consistent_snapshot) : m_connection(conn) {
-    conn->execute(g_isolation_level[level]);
-    conn->execute(g_consistent_snapshot[consistent_snapshot]);
+transaction::transaction(connection *conn, isolation::level level, bool consistent_snapshot, bool read_only)
+    : m_connection(conn) {
+    // the level only applies to this transaction and goes in the same round trip as the start, the
+    // connection is already established by create_transaction()
+    std::string query = g_isolation_level[level];
+    query += g_start_transaction[consistent_snapshot][read_only];
+
+    u64 affected_rows = 0;
+    conn->run_statements(query, affected_rows, nullptr);
 }
 
 transaction::~transaction() {
@@ -51,7 +58,7 @@ void transaction::commit() {
     if (!m_connection)
         return;
 
-    mysql_commit(m_connection->m_mysql);
+    m_connection->commit_transaction();
     cleanup();
     m_connection = nullptr;
 }
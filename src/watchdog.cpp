@@ -0,0 +1,253 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mysql.h>
+#include <mariadb++/connection_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "watchdog.hpp"
+
+using namespace mariadb;
+
+namespace {
+typedef std::chrono::steady_clock clock_type;
+
+namespace state {
+enum type { armed, killing, fired };
+}
+
+//
+// Call watched by a guard
+//
+struct entry {
+    // when to interrupt the call
+    clock_type::time_point m_deadline;
+    // account to lease the side connection for
+    account_ref m_account;
+    // server thread id of the watched connection
+    u64 m_thread_id;
+    state::type m_state;
+};
+
+//
+// Deadline of an armed call, ordered for a min heap. Items of disarmed or moved deadlines stay in
+// the heap until they surface
+//
+struct pending {
+    clock_type::time_point m_deadline;
+    u64 m_ticket;
+
+    bool operator>(const pending &other) const {
+        return m_deadline > other.m_deadline;
+    }
+};
+
+//
+// State shared by all guards, never destroyed as the thread is detached
+//
+struct watcher {
+    std::mutex m_lock;
+    // signaled when a deadline moves closer
+    std::condition_variable m_wake;
+    // signaled when a KILL QUERY is done
+    std::condition_variable m_done;
+    // armed calls by ticket
+    std::map<u64, entry> m_entries;
+    // deadlines of armed calls, earliest first
+    std::vector<pending> m_deadlines;
+    // pools of side connections by account
+    std::map<const account *, connection_pool_ref> m_pools;
+    // next ticket to hand out
+    u64 m_next_ticket = 1;
+    // indicates whether the thread is started
+    bool m_running = false;
+};
+
+void run(watcher &w);
+
+watcher &get_watcher() {
+    static watcher *w = new watcher();
+    return *w;
+}
+
+//
+// Queue the deadline of ticket, requires the lock
+//
+void schedule(watcher &w, u64 ticket, const clock_type::time_point &deadline) {
+    // rebuild once mostly stale items of disarmed calls are left, so the heap stays bounded
+    if (w.m_deadlines.size() > 2 * w.m_entries.size() + 64) {
+        w.m_deadlines.clear();
+        for (const auto &armed : w.m_entries)
+            if (armed.second.m_state == state::armed)
+                w.m_deadlines.push_back(pending{armed.second.m_deadline, armed.first});
+
+        std::make_heap(w.m_deadlines.begin(), w.m_deadlines.end(), std::greater<pending>());
+    }
+
+    w.m_deadlines.push_back(pending{deadline, ticket});
+    std::push_heap(w.m_deadlines.begin(), w.m_deadlines.end(), std::greater<pending>());
+}
+
+//
+// Arm a call, requires the lock. Returns its ticket
+//
+u64 arm(watcher &w, const account_ref &account, u64 thread_id, const clock_type::time_point &deadline) {
+    entry e;
+    e.m_deadline = deadline;
+    e.m_account = account;
+    e.m_thread_id = thread_id;
+    e.m_state = state::armed;
+
+    const u64 ticket = w.m_next_ticket++;
+    w.m_entries.emplace(ticket, e);
+    schedule(w, ticket, deadline);
+
+    if (!w.m_running) {
+        w.m_running = true;
+        std::thread(run, std::ref(w)).detach();
+    } else
+        w.m_wake.notify_one();
+
+    return ticket;
+}
+
+//
+// Interrupt the running statement of thread_id, errors are ignored as the call is done anyway
+//
+void kill_query(watcher &w, const account_ref &account, u64 thread_id) {
+    connection_pool_ref pool;
+    {
+        std::lock_guard<std::mutex> lock(w.m_lock);
+        connection_pool_ref &p = w.m_pools[account.get()];
+
+        if (!p)
+            p = connection_pool::create(account, 1);
+
+        pool = p;
+    }
+
+    try {
+        pool->acquire()->execute("KILL QUERY " + std::to_string(thread_id));
+    } catch (const std::exception &) {
+    }
+}
+
+void run(watcher &w) {
+    mysql_thread_init();
+
+    std::unique_lock<std::mutex> lock(w.m_lock);
+    while (true) {
+        // skip items of disarmed calls and of deadlines moved by fire()
+        auto next = w.m_entries.end();
+        while (!w.m_deadlines.empty()) {
+            const pending &top = w.m_deadlines.front();
+            next = w.m_entries.find(top.m_ticket);
+
+            if (next != w.m_entries.end() && next->second.m_state == state::armed &&
+                next->second.m_deadline == top.m_deadline)
+                break;
+
+            std::pop_heap(w.m_deadlines.begin(), w.m_deadlines.end(), std::greater<pending>());
+            w.m_deadlines.pop_back();
+            next = w.m_entries.end();
+        }
+
+        if (next == w.m_entries.end()) {
+            w.m_wake.wait(lock);
+            continue;
+        }
+
+        if (next->second.m_deadline > clock_type::now()) {
+            w.m_wake.wait_until(lock, next->second.m_deadline);
+            continue;
+        }
+
+        std::pop_heap(w.m_deadlines.begin(), w.m_deadlines.end(), std::greater<pending>());
+        w.m_deadlines.pop_back();
+
+        // the entry stays while killing, disarm waits for it
+        next->second.m_state = state::killing;
+        const account_ref account = next->second.m_account;
+        const u64 thread_id = next->second.m_thread_id;
+
+        lock.unlock();
+        kill_query(w, account, thread_id);
+        lock.lock();
+
+        next->second.m_state = state::fired;
+        w.m_done.notify_all();
+    }
+}
+}  // namespace
+
+watchdog::guard::guard(const account_ref &account, u64 thread_id, u64 timeout_ms)
+    : m_thread_id(thread_id), m_ticket(0), m_fired(false) {
+    if (!timeout_ms)
+        return;
+
+    // armed by fire() only
+    if (timeout_ms == never) {
+        m_account = account;
+        return;
+    }
+
+    watcher &w = get_watcher();
+    std::lock_guard<std::mutex> lock(w.m_lock);
+    m_ticket = arm(w, account, thread_id, clock_type::now() + std::chrono::milliseconds(timeout_ms));
+}
+
+watchdog::guard::~guard() {
+    disarm();
+}
+
+bool watchdog::guard::disarm() {
+    // a guard without timeout can no longer be armed
+    m_account.reset();
+
+    if (!m_ticket)
+        return m_fired;
+
+    watcher &w = get_watcher();
+    std::unique_lock<std::mutex> lock(w.m_lock);
+
+    auto it = w.m_entries.find(m_ticket);
+    w.m_done.wait(lock, [&it] { return it->second.m_state != state::killing; });
+
+    m_fired = it->second.m_state == state::fired;
+    w.m_entries.erase(it);
+    m_ticket = 0;
+
+    return m_fired;
+}
+
+void watchdog::guard::fire() {
+    watcher &w = get_watcher();
+    std::lock_guard<std::mutex> lock(w.m_lock);
+
+    if (!m_ticket) {
+        if (m_account)
+            m_ticket = arm(w, m_account, m_thread_id, clock_type::time_point::min());
+
+        return;
+    }
+
+    auto it = w.m_entries.find(m_ticket);
+    if (it == w.m_entries.end() || it->second.m_state != state::armed)
+        return;
+
+    it->second.m_deadline = clock_type::time_point::min();
+    schedule(w, m_ticket, it->second.m_deadline);
+    w.m_wake.notify_one();
+}
@@ -0,0 +1,58 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef _MARIADB_WATCHDOG_HPP_
+#define _MARIADB_WATCHDOG_HPP_
+
+#include <mariadb++/account.hpp>
+
+namespace mariadb {
+namespace watchdog {
+// timeout of a guard which only fires when fired explicitly
+const u64 never = ~0ull;
+
+//
+// Watches a call in flight on the connection with the given server thread id. Once the timeout
+// passes or the guard is fired, one thread issues KILL QUERY on a side connection leased from a
+// pool per account. The interrupted call fails while its connection stays usable.
+//
+// A guard with timeout 0 is not armed and costs nothing. A guard with timeout never is only
+// armed by fire(), until then it costs nothing either.
+//
+class guard {
+public:
+    guard(const account_ref &account, u64 thread_id, u64 timeout_ms);
+    ~guard();
+
+    //
+    // Stop watching, waits for a KILL QUERY in progress. Returns true if the call was interrupted
+    //
+    bool disarm();
+
+    //
+    // Interrupt the call now. Must not race with disarm(), callers on other threads synchronize
+    // with the thread owning the guard
+    //
+    void fire();
+
+private:
+    guard(const guard &) = delete;
+    guard &operator=(const guard &) = delete;
+
+    // account and server thread id of the watched call, kept until armed by fire()
+    account_ref m_account;
+    u64 m_thread_id;
+    // ticket of this guard, 0 if not armed or once disarmed
+    u64 m_ticket;
+    // indicates whether the call was interrupted
+    bool m_fired;
+};
+}  // namespace watchdog
+}  // namespace mariadb
+
+#endif
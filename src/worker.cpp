@@ -9,35 +9,117 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include "worker.hpp"
+#include "watchdog.hpp"
 #include <mariadb++/concurrency.hpp>
+#include <mariadb++/exceptions.hpp>
+#include "private.hpp"
 
 using namespace mariadb;
 using namespace mariadb::concurrency;
 
+namespace {
 //
-// Constructors
+// Publishes the guard of a running job to cancel() while in scope
 //
-worker::worker()
-    : m_keep_handle(false), m_handle(0), m_status(status::removed), m_command(command::query), m_result(0) {}
+class published_guard {
+public:
+    published_guard(std::mutex &lock, watchdog::guard *&target, watchdog::guard &guard)
+        : m_lock(lock), m_target(target) {
+        std::lock_guard<std::mutex> hold(m_lock);
+        m_target = &guard;
+    }
+
+    ~published_guard() {
+        std::lock_guard<std::mutex> hold(m_lock);
+        m_target = nullptr;
+    }
 
-worker::worker(account_ref &account, handle handle, bool keep_handle, command::type command, const std::string &query)
-    : m_keep_handle(keep_handle),
+private:
+    std::mutex &m_lock;
+    watchdog::guard *&m_target;
+};
+}  // namespace
+
+//
+// Constructors
+//
+worker::worker(const connection_pool_ref &pool, handle handle, bool keep_handle, command::type command,
+               const std::string &query)
+    : m_refs(1),
+      m_next(nullptr),
+      m_keep_handle(keep_handle),
       m_handle(handle),
       m_status(handle > 0 ? status::waiting : status::removed),
       m_command(command),
       m_result(0),
+      m_cancelled(false),
+      m_guard(nullptr),
       m_query(query),
-      m_account(account) {}
+      m_pool(pool) {}
 
-worker::worker(account_ref &account, handle handle, bool keep_handle, command::type command, statement_ref &statement)
-    : m_keep_handle(keep_handle),
+worker::worker(const connection_pool_ref &pool, handle handle, bool keep_handle, command::type command,
+               statement_ref &statement)
+    : m_refs(1),
+      m_next(nullptr),
+      m_keep_handle(keep_handle),
       m_handle(handle),
       m_status(handle > 0 ? status::waiting : status::removed),
       m_command(command),
       m_result(0),
-      m_account(account),
+      m_cancelled(false),
+      m_guard(nullptr),
+      m_pool(pool),
       m_statement(statement) {}
 
+worker::worker(const connection_pool_ref &pool, isolation::level level, std::vector<std::string> &&queries)
+    : m_refs(1),
+      m_next(nullptr),
+      m_keep_handle(false),
+      m_handle(0),
+      m_status(status::waiting),
+      m_command(command::transaction),
+      m_result(0),
+      m_cancelled(false),
+      m_guard(nullptr),
+      m_queries(std::move(queries)),
+      m_level(level),
+      m_promise(new std::promise<u64>()),
+      m_pool(pool) {}
+
+//
+// Reference counting
+//
+void worker::retain() {
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void worker::release() {
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+//
+// Intrusive link used by the submission queue
+//
+worker *worker::next() const {
+    return m_next;
+}
+
+void worker::next(worker *w) {
+    m_next = w;
+}
+
+//
+// Deadline after which the worker is skipped instead of executed
+//
+void worker::deadline(const std::chrono::steady_clock::time_point &deadline) {
+    m_deadline = deadline;
+}
+
+bool worker::expired(const std::chrono::steady_clock::time_point &now) const {
+    return m_deadline != std::chrono::steady_clock::time_point() && now >= m_deadline;
+}
+
 //
 // Get informations
 //
@@ -60,25 +142,55 @@ u64 worker::result() const {
     return m_result;
 }
 
+std::future<u64> worker::future() {
+    return m_promise->get_future();
+}
+
 result_set_ref worker::result_set() const {
-    return m_result_set;
+    // the result set is only written before the status is published
+    return m_status == status::succeed ? m_result_set : result_set_ref();
 }
 
 //
 // Do the actual job
 //
-void worker::execute() {
+void worker::execute(const connection_ref &session) {
+    if (m_cancelled) {
+        finish_cancelled();
+        return;
+    }
+
     m_status = status::executing;
 
     try {
-        connection_ref connection = m_statement ? m_statement->m_connection : connection::create(m_account);
+        // sessions of channels keep their state, including transactions
+        connection_ref connection = session;
+
+        if (!connection) {
+            if (m_statement)
+                connection = m_statement->m_connection;
+            else if (m_pool)
+                connection = m_pool->acquire();
+            else
+                throw std::logic_error("No account set for concurrency");
+
+            //
+            // Make sure auto commit mode is on before continuing. Pooled connections come back
+            // reset, including the sessions of channels, so the cached mode is accurate
+            //
+            connection->set_auto_commit(true);
+        }
 
-        //
-        // Make sure auto commit mode is on before continuing...
-        //
-        connection->set_auto_commit(true);
         connection->connect();
 
+        // cancel() fires the guard, which interrupts the running statement. It is only armed then,
+        // jobs which are not cancelled never reach the watchdog
+        watchdog::guard guard(connection->account(), connection->thread_id(), watchdog::never);
+        published_guard published(m_cancel_lock, m_guard, guard);
+
+        if (m_cancelled)
+            throw exception::timeout(0, "Query was cancelled");
+
         switch (m_command) {
             case command::execute:
                 if (m_statement)
@@ -95,16 +207,72 @@ void worker::execute() {
                 break;
 
             case command::query:
+                // materialized results do not hold on to the connection or statement
                 if (m_statement)
-                    m_result_set = m_statement->query();
+                    m_result_set = m_statement->query()->materialize();
                 else
-                    m_result_set = connection->query(m_query.c_str());
+                    m_result_set = connection->query(m_query.c_str())->materialize();
                 break;
+
+            case command::transaction: {
+                // rolls back on destruction unless committed
+                transaction_ref tx = connection->create_transaction(m_level);
+                u64 affected = 0;
+
+                for (const std::string &query : m_queries) affected += connection->execute(query);
+
+                tx->commit();
+                m_result = affected;
+                break;
+            }
         }
 
         m_status = status::succeed;
+
+        if (m_promise)
+            m_promise->set_value(m_result);
     } catch (const std::exception &e) {
-        std::cout << e.what() << std::endl;
+        // the job most likely failed because it was interrupted
+        if (m_cancelled) {
+            finish_cancelled();
+            return;
+        }
+
+        // errors of the library itself were reported where they were raised
+        if (!dynamic_cast<const exception::base *>(&e))
+            error_log::report(0, e.what(), 0, m_query, __FUNCTION__, __FILE__, __LINE__);
+
         m_status = status::failed;
+
+        if (m_promise)
+            m_promise->set_exception(std::current_exception());
     }
 }
+
+//
+// Cancel the job, interrupts it if running
+//
+void worker::cancel() {
+    m_cancelled = true;
+
+    std::lock_guard<std::mutex> lock(m_cancel_lock);
+    if (m_guard)
+        m_guard->fire();
+}
+
+void worker::finish_cancelled() {
+    m_status = status::cancelled;
+
+    if (m_promise)
+        m_promise->set_exception(std::make_exception_ptr(exception::timeout(0, "Query was cancelled")));
+}
+
+//
+// Give up on the job without executing it
+//
+void worker::skip(const std::string &reason) {
+    m_status = status::skipped;
+
+    if (m_promise)
+        m_promise->set_exception(std::make_exception_ptr(exception::queue(reason)));
+}
@@ -11,27 +11,60 @@
 #ifndef _MARIADB_WORKER_HPP_
 #define _MARIADB_WORKER_HPP_
 
-#include <mariadb++/connection.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <mariadb++/connection_pool.hpp>
 #include <mariadb++/concurrency.hpp>
 
 namespace mariadb {
 using namespace concurrency;
 
+namespace watchdog {
+class guard;
+}
+
 namespace command {
-enum type { execute, insert, query };
+enum type { execute, insert, query, transaction };
 }
 
 //
 // Worker entity used by concurrency namespace
 //
+// Workers are reference counted: the worker thread holds one reference until the job is done and
+// the handle table holds another one while the handle is kept. Status and results are published
+// through atomics, readers never need a lock.
+//
 class worker {
 public:
     //
     // Constructor
     //
-    worker();
-    worker(account_ref &account, handle hnd, bool keep_handle, command::type command, const std::string &query);
-    worker(account_ref &account, handle hnd, bool keep_handle, command::type command, statement_ref &statement);
+    worker(const connection_pool_ref &pool, handle hnd, bool keep_handle, command::type command,
+           const std::string &query);
+    worker(const connection_pool_ref &pool, handle hnd, bool keep_handle, command::type command,
+           statement_ref &statement);
+    worker(const connection_pool_ref &pool, isolation::level level, std::vector<std::string> &&queries);
+
+    //
+    // Reference counting, release() deletes the worker when the last reference is dropped
+    //
+    void retain();
+    void release();
+
+    //
+    // Intrusive link used by the submission queue
+    //
+    worker *next() const;
+    void next(worker *w);
+
+    //
+    // Deadline after which the worker is skipped instead of executed
+    //
+    void deadline(const std::chrono::steady_clock::time_point &deadline);
+    bool expired(const std::chrono::steady_clock::time_point &now) const;
 
     //
     // Get informations
@@ -47,18 +80,51 @@ public:
     result_set_ref result_set() const;
 
     //
-    // Do the actual job
+    // Get the outcome of a transaction, valid once
     //
-    void execute();
+    std::future<u64> future();
+
+    //
+    // Do the actual job, on the session if given. Otherwise statements use their own connection
+    // and queries lease one from the pool
+    //
+    void execute(const connection_ref &session);
+
+    //
+    // Give up on the job without executing it
+    //
+    void skip(const std::string &reason);
+
+    //
+    // Cancel the job, interrupts it with KILL QUERY if running. Thread safe
+    //
+    void cancel();
 
 private:
+    // only deleted through release()
+    ~worker() = default;
+
+    //
+    // Publish cancellation as outcome
+    //
+    void finish_cancelled();
+
+    std::atomic<u32> m_refs;
+    worker *m_next;
+    std::chrono::steady_clock::time_point m_deadline;
     bool m_keep_handle;
     handle m_handle;
-    status::type m_status;
+    std::atomic<status::type> m_status;
     command::type m_command;
-    u64 m_result;
+    std::atomic<u64> m_result;
+    std::atomic<bool> m_cancelled;
+    std::mutex m_cancel_lock;
+    watchdog::guard *m_guard;
     std::string m_query;
-    account_ref m_account;
+    std::vector<std::string> m_queries;
+    isolation::level m_level;
+    std::unique_ptr<std::promise<u64>> m_promise;
+    connection_pool_ref m_pool;
     result_set_ref m_result_set;
     statement_ref m_statement;
 };
@@ -0,0 +1,156 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <thread>
+
+#include "CacheTest.h"
+
+TEST_P(CacheTest, testQueryHit) {
+    result_cache_ref cache = result_cache::create();
+    const std::string query = "SELECT id, str, dt FROM " + m_table_name + " ORDER BY id;";
+
+    for (int i = 0; i < 2; i++) {
+        result_set_ref rs = cache->query(m_con, query, {m_table_name});
+        ASSERT_TRUE(!!rs);
+        EXPECT_EQ(3u, rs->row_count());
+
+        ASSERT_TRUE(rs->next());
+        EXPECT_EQ(1, rs->get_signed32("id"));
+        EXPECT_EQ("one", rs->get_string("str"));
+        EXPECT_EQ("2012-12-21 13:37:42", rs->get_date_time("dt").str());
+
+        ASSERT_TRUE(rs->next());
+        EXPECT_TRUE(rs->get_is_null("str"));
+        EXPECT_TRUE(rs->get_is_null("dt"));
+
+        ASSERT_TRUE(rs->next());
+        EXPECT_EQ("three", rs->get_string(1));
+        EXPECT_FALSE(rs->next());
+    }
+
+    EXPECT_EQ(1u, cache->hits());
+    EXPECT_EQ(1u, cache->misses());
+    EXPECT_EQ(1u, cache->entry_count());
+}
+
+TEST_P(CacheTest, testStatementKey) {
+    result_cache_ref cache = result_cache::create();
+    statement_ref stmt = m_con->create_statement("SELECT str, dt FROM " + m_table_name + " WHERE id = ?;");
+
+    stmt->set_unsigned32(0, 1);
+    result_set_ref first = cache->query(stmt);
+    ASSERT_TRUE(first->next());
+    EXPECT_EQ("one", first->get_string(0));
+    EXPECT_EQ(date_time(2012, 12, 21, 13, 37, 42), first->get_date_time(1));
+
+    // different parameter, different entry
+    stmt->set_unsigned32(0, 3);
+    result_set_ref third = cache->query(stmt);
+    ASSERT_TRUE(third->next());
+    EXPECT_EQ("three", third->get_string(0));
+    EXPECT_TRUE(third->get_is_null(1));
+
+    // same parameter again is served from the cache
+    stmt->set_unsigned32(0, 1);
+    result_set_ref again = cache->query(stmt);
+    ASSERT_TRUE(again->next());
+    EXPECT_EQ("one", again->get_string(0));
+
+    EXPECT_EQ(1u, cache->hits());
+    EXPECT_EQ(2u, cache->entry_count());
+}
+
+TEST_P(CacheTest, testProtocolKey) {
+    result_cache_ref cache = result_cache::create();
+    const std::string query = "SELECT id FROM " + m_table_name + " ORDER BY id;";
+
+    // text and binary results of the same SQL hold differently encoded cells
+    result_set_ref text = cache->query(m_con, query);
+    result_set_ref binary = cache->query(m_con->create_statement(query));
+    EXPECT_EQ(0u, cache->hits());
+    EXPECT_EQ(2u, cache->entry_count());
+
+    ASSERT_TRUE(text->next());
+    EXPECT_EQ(1, text->get_signed32(0));
+    ASSERT_TRUE(binary->next());
+    EXPECT_EQ(1, binary->get_signed32(0));
+}
+
+TEST_P(CacheTest, testInvalidation) {
+    result_cache_ref cache = result_cache::create(64 * 1024 * 1024, 0);
+    const std::string query = "SELECT COUNT(*) FROM " + m_table_name + ";";
+
+    result_set_ref rs = cache->query(m_con, query, {m_table_name});
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(3u, rs->get_unsigned64(0));
+
+    m_con->execute("INSERT INTO " + m_table_name + " (str) VALUES ('four');");
+
+    // stale until invalidated
+    rs = cache->query(m_con, query, {m_table_name});
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(3u, rs->get_unsigned64(0));
+
+    cache->invalidate("unrelated");
+    EXPECT_EQ(1u, cache->entry_count());
+
+    cache->invalidate(m_table_name);
+    EXPECT_EQ(0u, cache->entry_count());
+    EXPECT_EQ(0u, cache->size());
+
+    rs = cache->query(m_con, query, {m_table_name});
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(4u, rs->get_unsigned64(0));
+}
+
+TEST_P(CacheTest, testExpiryAndEviction) {
+    result_cache_ref cache = result_cache::create();
+    const std::string query = "SELECT str FROM " + m_table_name + ";";
+
+    cache->query(m_con, query, {}, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    cache->query(m_con, query);
+    EXPECT_EQ(0u, cache->hits());
+
+    // shrink to exactly the most recently used entry
+    const u64 first_size = cache->size();
+    cache->query(m_con, "SELECT id FROM " + m_table_name + ";");
+    cache->set_max_size(cache->size() - first_size);
+    EXPECT_EQ(1u, cache->entry_count());
+
+    cache->query(m_con, "SELECT id FROM " + m_table_name + ";");
+    EXPECT_EQ(1u, cache->hits());
+}
+
+TEST_P(CacheTest, testKeyScope) {
+    result_cache_ref cache = result_cache::create(64 * 1024 * 1024, 1);
+    const std::string schema = m_con->schema();
+    const std::string query = "SELECT DATABASE();";
+
+    // the same SQL in another schema is another entry
+    result_set_ref rs = cache->query(m_con, query, {}, 0);
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(schema, rs->get_string(0));
+
+    ASSERT_TRUE(m_con->set_schema("information_schema"));
+    rs = cache->query(m_con, query, {}, 0);
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ("information_schema", rs->get_string(0));
+    EXPECT_EQ(0u, cache->hits());
+
+    // a time to live of zero never expires, unlike the default of the cache
+    ASSERT_TRUE(m_con->set_schema(schema));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    rs = cache->query(m_con, query);
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(schema, rs->get_string(0));
+    EXPECT_EQ(1u, cache->hits());
+    EXPECT_EQ(2u, cache->entry_count());
+}
+
+INSTANTIATE_TEST_SUITE_P(BufUnbuf, CacheTest, ::testing::Values(true, false));
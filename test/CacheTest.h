@@ -0,0 +1,25 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_CACHETEST_H
+#define MARIADBCLIENTPP_CACHETEST_H
+
+#include <mariadb++/result_cache.hpp>
+#include "SkeletonTest.h"
+
+class CacheTest : public SkeletonTest {
+   protected:
+    virtual void CreateTestTable() override {
+        m_con->execute("CREATE TABLE " + m_table_name +
+                       " (id INT AUTO_INCREMENT, str VARCHAR(50) NULL, dt DATETIME NULL, PRIMARY KEY(id));");
+        m_con->execute("INSERT INTO " + m_table_name +
+                       " (str, dt) VALUES ('one', '2012-12-21 13:37:42'), (NULL, NULL), ('three', NULL);");
+    }
+};
+
+#endif  // MARIADBCLIENTPP_CACHETEST_H
@@ -0,0 +1,109 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <thread>
+
+#include "ClusterTest.h"
+
+TEST_P(ClusterTest, testPoolReuse) {
+    connection_pool_ref pool = connection_pool::create(CreateEndpoint(), 1);
+    connection *raw;
+    {
+        connection_ref conn = pool->acquire();
+        raw = conn.get();
+        EXPECT_EQ(1u, pool->outstanding());
+        EXPECT_TRUE(conn->query("SELECT 1")->next());
+    }
+
+    EXPECT_EQ(0u, pool->outstanding());
+    EXPECT_EQ(1u, pool->idle());
+
+    // the idle connection is handed out again
+    connection_ref conn = pool->acquire();
+    EXPECT_EQ(raw, conn.get());
+    EXPECT_TRUE(conn->connected());
+}
+
+TEST_P(ClusterTest, testPoolReset) {
+    connection_pool_ref pool = connection_pool::create(CreateEndpoint(), 1);
+    {
+        connection_ref conn = pool->acquire();
+        conn->execute("SET @pooled = 1;");
+        conn->execute("CREATE TEMPORARY TABLE " + m_table_name + "_tmp (id INT);");
+        conn->set_auto_commit(false);
+        conn->insert("INSERT INTO " + m_table_name + " (str) VALUES('uncommitted');");
+    }
+
+    // the next lease starts with a clean session
+    connection_ref conn = pool->acquire();
+    EXPECT_TRUE(conn->auto_commit());
+
+    result_set_ref rs = conn->query("SELECT @pooled IS NULL, @@autocommit, COUNT(*) FROM " + m_table_name + ";");
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(1, rs->get_signed64(0));
+    EXPECT_EQ(1, rs->get_signed64(1));
+    EXPECT_EQ(0, rs->get_signed64(2));
+    EXPECT_THROW(conn->query("SELECT * FROM " + m_table_name + "_tmp;"), exception::connection);
+}
+
+TEST_P(ClusterTest, testReadWriteSplit) {
+    account_ref primary = CreateEndpoint();
+    account_ref replica_a = CreateEndpoint();
+    account_ref replica_b = CreateEndpoint();
+    cluster_ref db = cluster::create(primary, {replica_a, replica_b});
+
+    connection_ref writer = db->writer();
+    EXPECT_EQ(primary, writer->account());
+    EXPECT_NE(0u, writer->insert("INSERT INTO " + m_table_name + " (str) VALUES('routed');"));
+
+    // least outstanding: two concurrent readers end up on different replicas
+    connection_ref first = db->reader();
+    connection_ref second = db->reader();
+    EXPECT_NE(primary, first->account());
+    EXPECT_NE(primary, second->account());
+    EXPECT_NE(first->account(), second->account());
+    EXPECT_EQ(1u, db->replica(0)->outstanding());
+    EXPECT_EQ(1u, db->replica(1)->outstanding());
+
+    result_set_ref rs = first->query("SELECT COUNT(*) FROM " + m_table_name + ";");
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(1u, rs->get_unsigned64(0));
+}
+
+TEST_P(ClusterTest, testReplicaFallback) {
+    account_ref primary = CreateEndpoint();
+    cluster_ref db = cluster::create(primary, {});
+
+    EXPECT_EQ(primary, db->reader()->account());
+
+    // enabled lag checks must never prevent reading
+    cluster_ref lagging = cluster::create(primary, {CreateEndpoint()});
+    lagging->set_max_replica_lag(1);
+    connection_ref conn = lagging->reader();
+    ASSERT_TRUE(!!conn);
+    EXPECT_TRUE(conn->connected() || conn->connect());
+}
+
+TEST_P(ClusterTest, testStickySession) {
+    account_ref primary = CreateEndpoint();
+    cluster_ref db = cluster::create(primary, {CreateEndpoint()});
+    cluster_session_ref session = db->create_session();
+
+    // no write yet, reads go to the replica
+    EXPECT_NE(primary, session->reader()->account());
+
+    session->writer()->execute("INSERT INTO " + m_table_name + " (str) VALUES('sticky');");
+    EXPECT_EQ(primary, session->reader()->account());
+
+    // outside of the window reads go to the replica again
+    db->set_sticky_window(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_NE(primary, session->reader()->account());
+}
+
+INSTANTIATE_TEST_SUITE_P(BufUnbuf, ClusterTest, ::testing::Values(true, false));
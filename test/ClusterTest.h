@@ -0,0 +1,31 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_CLUSTERTEST_H
+#define MARIADBCLIENTPP_CLUSTERTEST_H
+
+#include <mariadb++/cluster.hpp>
+#include "SkeletonTest.h"
+
+class ClusterTest : public SkeletonTest {
+   protected:
+    virtual void CreateTestTable() override {
+        m_con->execute("CREATE TABLE " + m_table_name + " (id INT AUTO_INCREMENT, str VARCHAR(50) NULL, PRIMARY KEY(id));");
+    }
+
+    // all endpoints point to the test server, but use distinct accounts to tell them apart
+    account_ref CreateEndpoint() {
+        account_ref acc = account::create(m_account_setup->host_name(), m_account_setup->user_name(),
+                                          m_account_setup->password(), m_account_setup->schema(),
+                                          m_account_setup->port(), m_account_setup->unix_socket());
+        acc->set_store_result(GetParam());
+        return acc;
+    }
+};
+
+#endif  // MARIADBCLIENTPP_CLUSTERTEST_H
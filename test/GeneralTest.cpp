@@ -8,6 +8,11 @@
 
 #include "GeneralTest.h"
 #include "mariadb++/concurrency.hpp"
+#include "mariadb++/error_log.hpp"
+#include "mariadb++/exceptions.hpp"
+#include "mariadb++/tracing.hpp"
+
+#include <thread>
 
 TEST_P(GeneralTest, testCreateFail) {
     // intended syntax error
@@ -67,4 +72,292 @@ TEST_P(GeneralTest, testConcurrentInsert) {
     EXPECT_EQ(num_results, results.size());
 }
 
+TEST_P(GeneralTest, testConcurrentHandleReuse) {
+    concurrency::set_account(m_account_setup);
+
+    handle first = concurrency::query("SELECT 1;", true);
+    ASSERT_TRUE(concurrency::wait_handle(first, 1));
+    concurrency::release_handle(first);
+
+    // the released handle stays invalid, even when its slot is reused
+    handle second = concurrency::query("SELECT 2;", true);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(concurrency::status::removed, concurrency::worker_status(first));
+    EXPECT_FALSE(concurrency::get_query_result(first));
+
+    ASSERT_TRUE(concurrency::wait_handle(second, 1));
+    result_set_ref rs = concurrency::get_query_result(second);
+    concurrency::release_handle(second);
+    concurrency::release_handle(second);
+
+    ASSERT_TRUE(rs && rs->next());
+    EXPECT_EQ(2, rs->get_signed64(0));
+}
+
+TEST_P(GeneralTest, testConcurrentChannels) {
+    concurrency::set_account(m_account_setup);
+
+    // session state carries over within a channel, channels do not share it
+    concurrency::channel_ref first = concurrency::create_channel();
+    concurrency::channel_ref second = concurrency::create_channel();
+
+    concurrency::execute(first, "SET @channel = 1;");
+    concurrency::execute(second, "SET @channel = 2;");
+    concurrency::execute(first, "CREATE TEMPORARY TABLE channel_tmp (id INT);");
+    concurrency::execute(first, "INSERT INTO channel_tmp VALUES (1), (2), (3);");
+
+    handle h1 = concurrency::query(first, "SELECT @channel, COUNT(*) FROM channel_tmp;", true);
+    handle h2 = concurrency::query(second, "SELECT @channel;", true);
+
+    ASSERT_TRUE(concurrency::wait_handle(h1, 1));
+    ASSERT_TRUE(concurrency::wait_handle(h2, 1));
+
+    result_set_ref rs1 = concurrency::get_query_result(h1);
+    result_set_ref rs2 = concurrency::get_query_result(h2);
+    concurrency::release_handle(h1);
+    concurrency::release_handle(h2);
+
+    ASSERT_TRUE(rs1 && rs1->next());
+    EXPECT_EQ(1, rs1->get_signed64(0));
+    EXPECT_EQ(3, rs1->get_signed64(1));
+
+    ASSERT_TRUE(rs2 && rs2->next());
+    EXPECT_EQ(2, rs2->get_signed64(0));
+}
+
+TEST_P(GeneralTest, testConcurrentChannelRelease) {
+    concurrency::set_account(m_account_setup);
+
+    // leave session state behind in a channel, then drop it so its session returns to the pool
+    {
+        concurrency::channel_ref channel = concurrency::create_channel();
+        concurrency::execute(channel, "SET @channel = 1;");
+        handle h = concurrency::execute(channel, "SET autocommit = 0;", true);
+        ASSERT_TRUE(concurrency::wait_handle(h, 1));
+        concurrency::release_handle(h);
+    }
+
+    // the drain thread lets go of the channel after finishing its last worker
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    handle h = concurrency::query("SELECT @channel IS NULL, @@autocommit;", true);
+    ASSERT_TRUE(concurrency::wait_handle(h, 1));
+    result_set_ref rs = concurrency::get_query_result(h);
+    concurrency::release_handle(h);
+
+    ASSERT_TRUE(rs && rs->next());
+    EXPECT_EQ(1, rs->get_signed64(0));
+    EXPECT_EQ(1, rs->get_signed64(1));
+}
+
+TEST_P(GeneralTest, testConcurrentTransaction) {
+    concurrency::set_account(m_account_setup);
+    const std::string insert = "INSERT INTO " + m_table_name + " (str) VALUES ('tx');";
+
+    concurrency::async_transaction_ref tx = concurrency::begin_transaction(isolation::read_committed);
+    tx->execute(insert).execute(insert);
+    EXPECT_EQ(2u, tx->commit().get());
+    EXPECT_THROW(tx->commit(), std::logic_error);
+
+    // a failing statement rolls back the whole transaction
+    concurrency::async_transaction_ref failing = concurrency::begin_transaction();
+    failing->execute(insert).execute("INSERT INTO " + m_table_name + " (nope) VALUES (1);");
+    EXPECT_ANY_THROW(failing->commit().get());
+
+    result_set_ref rs = m_con->query("SELECT COUNT(*) FROM " + m_table_name + ";");
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(2, rs->get_signed64(0));
+}
+
+TEST_P(GeneralTest, testConcurrentQueueLimit) {
+    concurrency::set_account(m_account_setup);
+    concurrency::channel_ref channel = concurrency::create_channel();
+    const concurrency::queue_metrics before = concurrency::get_queue_metrics();
+
+    // at most one worker waits behind the sleeping one
+    concurrency::set_queue_limit(1, concurrency::overflow::fail);
+
+    int rejected = 0;
+    for (int i = 0; i < 3; i++) {
+        try {
+            concurrency::execute(channel, "DO SLEEP(0.2);");
+        } catch (const exception::queue &) {
+            rejected++;
+        }
+    }
+
+    // queued work expires while the sleep runs
+    concurrency::channel_ref slow = concurrency::create_channel();
+    concurrency::set_queue_limit(0, concurrency::overflow::block, 50);
+    concurrency::execute(slow, "DO SLEEP(0.2);");
+    handle stale = concurrency::query(slow, "SELECT 1;", true);
+
+    EXPECT_FALSE(concurrency::wait_handle(stale, 1));
+    EXPECT_EQ(concurrency::status::skipped, concurrency::worker_status(stale));
+    concurrency::release_handle(stale);
+    concurrency::set_queue_limit(0);
+
+    const concurrency::queue_metrics after = concurrency::get_queue_metrics();
+    EXPECT_LT(0, rejected);
+    EXPECT_EQ(static_cast<u64>(rejected), after.rejected - before.rejected);
+    EXPECT_EQ(1u, after.expired - before.expired);
+}
+
+TEST_P(GeneralTest, testQueryTimeout) {
+    m_con->set_query_timeout(100);
+    EXPECT_THROW(m_con->execute("DO SLEEP(5);"), exception::timeout);
+
+    statement_ref stmt = m_con->create_statement("DO SLEEP(?);");
+    stmt->set_unsigned32(0, 5);
+    EXPECT_THROW(stmt->execute(), exception::timeout);
+
+    // the connection stays usable
+    m_con->set_query_timeout(0);
+    result_set_ref rs = m_con->query("SELECT 1;");
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(1, rs->get_signed64(0));
+}
+
+TEST_P(GeneralTest, testConcurrentCancel) {
+    concurrency::set_account(m_account_setup);
+    concurrency::channel_ref channel = concurrency::create_channel();
+
+    handle running = concurrency::execute(channel, "DO SLEEP(5);", true);
+    handle queued = concurrency::query(channel, "SELECT 1;", true);
+
+    while (concurrency::worker_status(running) == concurrency::status::waiting)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    concurrency::cancel(queued);
+    concurrency::cancel(running);
+
+    EXPECT_FALSE(concurrency::wait_handle(running, 1));
+    EXPECT_FALSE(concurrency::wait_handle(queued, 1));
+    EXPECT_EQ(concurrency::status::cancelled, concurrency::worker_status(running));
+    EXPECT_EQ(concurrency::status::cancelled, concurrency::worker_status(queued));
+
+    concurrency::release_handle(running);
+    concurrency::release_handle(queued);
+}
+
+TEST_P(GeneralTest, testErrorCategory) {
+    try {
+        m_con->execute("SELEKT 1;");
+        FAIL() << "no exception";
+    } catch (const exception::connection &e) {
+        EXPECT_EQ(error_category::syntax, e.category());
+        EXPECT_EQ("42000", e.sqlstate());
+        EXPECT_FALSE(e.transient());
+    }
+
+    EXPECT_EQ(error_category::syntax, m_con->category());
+    EXPECT_EQ("42000", m_con->sqlstate());
+
+    statement_ref stmt = m_con->create_statement("INSERT INTO " + m_table_name + " (id, str) VALUES (?, 'dup');");
+    stmt->set_unsigned32(0, 1);
+    stmt->insert();
+
+    try {
+        stmt->insert();
+        FAIL() << "no exception";
+    } catch (const exception::statement &e) {
+        EXPECT_EQ(1062u, e.error_id());
+        EXPECT_EQ(error_category::duplicate_key, e.category());
+        EXPECT_EQ("23000", e.sqlstate());
+    }
+
+    EXPECT_EQ(error_category::duplicate_key, stmt->category());
+    EXPECT_EQ(error_category::none, error_category::classify(0));
+    EXPECT_EQ(error_category::deadlock, error_category::classify(1213));
+    EXPECT_TRUE(error_category::transient(error_category::deadlock));
+    EXPECT_TRUE(error_category::transient(error_category::connection_lost));
+    EXPECT_EQ(error_category::timeout, exception::timeout(0, "Query was cancelled").category());
+}
+
+TEST_P(GeneralTest, testTryVariants) {
+    expected<u64> id = m_con->try_insert("INSERT INTO " + m_table_name + " (id, str) VALUES (1, 'one');");
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(1u, *id);
+
+    expected<u64> duplicate = m_con->try_insert("INSERT INTO " + m_table_name + " (id, str) VALUES (1, 'one');");
+    ASSERT_FALSE(duplicate);
+    EXPECT_EQ(1062u, duplicate.error().error_no);
+    EXPECT_EQ(error_category::duplicate_key, duplicate.error().category);
+    EXPECT_EQ("23000", duplicate.error().sqlstate);
+    EXPECT_EQ(0u, duplicate.value_or(0));
+    EXPECT_THROW(duplicate.value(), exception::base);
+    // value() raises what insert() would have raised
+    EXPECT_THROW(duplicate.value(), exception::connection);
+    EXPECT_EQ(exception_type::connection, duplicate.error().thrown);
+
+    EXPECT_EQ(error_category::syntax, m_con->try_execute("SELEKT 1;").error().category);
+
+    statement_ref stmt = m_con->create_statement("SELECT str FROM " + m_table_name + " WHERE id = ?;");
+    stmt->set_unsigned32(0, 1);
+
+    expected<result_set_ref> rs = stmt->try_query();
+    ASSERT_TRUE(rs.has_value());
+    EXPECT_FALSE((*rs)->try_get_string("str"));
+    ASSERT_TRUE((*rs)->next());
+
+    EXPECT_EQ("one", (*rs)->try_get_string("str").value());
+    EXPECT_EQ("Column index out of range", (*rs)->try_get_string("nope").error().message);
+    EXPECT_FALSE((*rs)->try_get_double(0).has_value());
+    EXPECT_THROW((*rs)->try_get_string("nope").value(), std::out_of_range);
+
+    // the connection stays usable
+    EXPECT_EQ(1u, m_con->try_execute("UPDATE " + m_table_name + " SET str = 'uno';").value());
+}
+
+TEST_P(GeneralTest, testTryWithoutServer) {
+    // nothing listens on port 1, connecting fails
+    account_ref bad_port = account::create(m_account_setup->host_name(), m_account_setup->user_name(),
+                                           m_account_setup->password(), m_account_setup->schema(), 1);
+    connection_ref con = connection::create(bad_port);
+
+    expected<u64> affected = error_info();
+    EXPECT_NO_THROW(affected = con->try_execute("SELECT 1;"));
+    ASSERT_FALSE(affected);
+    EXPECT_NE(0u, affected.error().error_no);
+    EXPECT_EQ(exception_type::connection, affected.error().thrown);
+    EXPECT_THROW(affected.value(), exception::connection);
+
+    expected<result_set_ref> rs = error_info();
+    EXPECT_NO_THROW(rs = con->try_query("SELECT 1;"));
+    EXPECT_FALSE(rs);
+}
+
+TEST_P(GeneralTest, testErrorLog) {
+    std::vector<error_log::record> records;
+    error_log::set_sink([&records](const error_log::record &r) { records.push_back(r); }, 2);
+
+    const std::string query = "SELECT nope FROM " + m_table_name + " WHERE id = 1;";
+    for (int i = 0; i < 5; i++) EXPECT_ANY_THROW(m_con->query(query));
+
+    // the rate limit counts dropped records towards the next one passed
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_ANY_THROW(m_con->execute(query));
+    error_log::set_sink(error_log::sink());
+
+    ASSERT_EQ(3u, records.size());
+    EXPECT_EQ(1054u, records[0].error_no);
+    EXPECT_EQ(m_con->thread_id(), records[0].connection_id);
+    EXPECT_EQ(tracing::fingerprint(query), records[0].fingerprint);
+    EXPECT_EQ(0u, records[1].suppressed);
+    EXPECT_EQ(3u, records[2].suppressed);
+
+    // without sink errors are only thrown
+    EXPECT_ANY_THROW(m_con->query(query));
+    EXPECT_EQ(3u, records.size());
+
+    // errors returned by the non-throwing calls are reported as well
+    error_log::set_sink([&records](const error_log::record &r) { records.push_back(r); }, 0);
+    EXPECT_FALSE(m_con->try_query(query));
+    error_log::set_sink(error_log::sink());
+
+    ASSERT_EQ(4u, records.size());
+    EXPECT_EQ(1054u, records[3].error_no);
+    EXPECT_EQ(tracing::fingerprint(query), records[3].fingerprint);
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, GeneralTest, ::testing::Values(true, false));
@@ -0,0 +1,114 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <sstream>
+
+#include "MetricsTest.h"
+
+TEST_P(MetricsTest, testOperationCounts) {
+    m_con->insert("INSERT INTO " + m_table_name + " (str) VALUES ('one'), ('two'), ('three');");
+    EXPECT_EQ(3u, m_con->execute("UPDATE " + m_table_name + " SET str = 'same';"));
+
+    result_set_ref rs = m_con->query("SELECT str FROM " + m_table_name + ";");
+    while (rs->next()) {
+    }
+
+    statement_ref stmt = m_con->create_statement("SELECT id FROM " + m_table_name + " WHERE id > ?;");
+    stmt->set_unsigned32(0, 1);
+    stmt->query();
+
+    EXPECT_ANY_THROW(m_con->execute("SELECT nope FROM " + m_table_name + ";"));
+
+    const metrics::snapshot s = metrics::get_snapshot();
+    const metrics::operation_metrics &execute = s.operations[operation::execute];
+
+    EXPECT_EQ(1u, s.operations[operation::insert].calls);
+    EXPECT_EQ(3u, s.operations[operation::insert].rows);
+    EXPECT_EQ(2u, execute.calls);
+    EXPECT_EQ(1u, execute.errors);
+    EXPECT_EQ(3u, execute.rows);
+    EXPECT_EQ(execute.calls, execute.latency.count());
+    EXPECT_LE(execute.latency.percentile(50), execute.latency.max());
+    EXPECT_EQ(1u, s.operations[operation::query].calls);
+    EXPECT_EQ(1u, s.operations[operation::prepare].calls);
+    EXPECT_EQ(1u, s.operations[operation::statement_query].calls);
+
+    // unknown column
+    ASSERT_EQ(1u, s.errors.count(1054));
+    EXPECT_EQ(1u, s.errors.at(1054));
+
+    // rows of the text protocol, the statement result was never fetched
+    EXPECT_EQ(3u, s.operations[operation::fetch].rows);
+    EXPECT_EQ(12u, s.operations[operation::fetch].bytes);
+}
+
+TEST_P(MetricsTest, testDisabled) {
+    metrics::disable();
+    EXPECT_FALSE(metrics::enabled());
+
+    m_con->execute("DO 1;");
+    EXPECT_EQ(0u, metrics::get_snapshot().operations[operation::execute].calls);
+}
+
+TEST_P(MetricsTest, testPrometheus) {
+    m_con->execute("DO 1;");
+
+    std::ostringstream os;
+    metrics::write_prometheus(os, metrics::get_snapshot(), "test");
+    const std::string text = os.str();
+
+    EXPECT_NE(std::string::npos, text.find("# TYPE test_operations_total counter\n"));
+    EXPECT_NE(std::string::npos, text.find("test_operations_total{operation=\"execute\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find("test_operation_duration_seconds_bucket{operation=\"execute\",le=\"+Inf\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find("test_operation_duration_seconds_count{operation=\"execute\"} 1\n"));
+}
+
+INSTANTIATE_TEST_SUITE_P(BufUnbuf, MetricsTest, ::testing::Values(true, false));
+
+// the histogram math and export need no server
+
+TEST(HistogramTest, testPercentiles) {
+    metrics::histogram h;
+    for (u64 i = 1; i <= 100; ++i) h.record(i * 1000);
+
+    EXPECT_EQ(100u, h.count());
+    EXPECT_EQ(5050000u, h.sum());
+    EXPECT_EQ(100000u, h.max());
+
+    // values are accurate to 1/16th
+    EXPECT_NEAR(50000.0, static_cast<f64>(h.percentile(50)), 50000.0 / 16);
+    EXPECT_NEAR(99000.0, static_cast<f64>(h.percentile(99)), 99000.0 / 16);
+    EXPECT_EQ(100000u, h.percentile(100));
+
+    for (u64 value : {0ull, 15ull, 16ull, 1000ull, 123456789ull}) {
+        const u32 index = metrics::histogram::bucket_index(value);
+        EXPECT_LE(value, metrics::histogram::bucket_upper_bound(index));
+        if (index) {
+            EXPECT_GT(value, metrics::histogram::bucket_upper_bound(index - 1));
+        }
+    }
+}
+
+TEST(HistogramTest, testPrometheusBounds) {
+    metrics::snapshot s;
+    s.operations[operation::execute].latency.record(98000);
+    s.operations[operation::execute].latency.record(99000);
+
+    // flags of the target stream do not change the output
+    std::ostringstream os;
+    os << std::hex << std::showpos;
+    metrics::write_prometheus(os, s, "test");
+    const std::string text = os.str();
+
+    // 100 us is exported as the edge of the bucket below, the one holding 99000 ns starts above
+    const std::string bucket = "test_operation_duration_seconds_bucket{operation=\"execute\",le=";
+    EXPECT_NE(std::string::npos, text.find(bucket + "\"0.000098303\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find(bucket + "\"0.000245759\"} 2\n"));
+    EXPECT_NE(std::string::npos, text.find("test_operation_duration_seconds_sum{operation=\"execute\"} 0.000197\n"));
+    EXPECT_NE(std::string::npos, text.find("test_operation_duration_seconds_count{operation=\"execute\"} 2\n"));
+}
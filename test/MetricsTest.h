@@ -0,0 +1,34 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_METRICSTEST_H
+#define MARIADBCLIENTPP_METRICSTEST_H
+
+#include <mariadb++/metrics.hpp>
+#include "SkeletonTest.h"
+
+class MetricsTest : public SkeletonTest {
+   protected:
+    virtual void SetUp() override {
+        SkeletonTest::SetUp();
+
+        metrics::enable();
+        metrics::reset();
+    }
+
+    virtual void TearDown() override {
+        metrics::disable();
+        SkeletonTest::TearDown();
+    }
+
+    virtual void CreateTestTable() override {
+        m_con->execute("CREATE TABLE " + m_table_name + " (id INT AUTO_INCREMENT, str VARCHAR(50), PRIMARY KEY(id));");
+    }
+};
+
+#endif  // MARIADBCLIENTPP_METRICSTEST_H
@@ -83,6 +83,33 @@ TEST_P(ParameterizedQueryTest, bindAnyDataType) {
     ParamTest_TEST(errorQuery->set_null(0), queryResult->get_is_null(0), "nul", true);
 }
 
+TEST_P(ParameterizedQueryTest, bindChrono) {
+    using namespace std::chrono;
+    const system_clock::time_point tp = time_point_cast<microseconds>(system_clock::now());
+    const microseconds du = -hours(838) + microseconds(1);
+
+    mariadb::statement_ref stmt =
+        m_con->create_statement("UPDATE " + m_table_name + " SET tim = ?, tiim = ? WHERE id = 1;");
+    stmt->set_time_point(0, tp);
+    stmt->set_duration(1, du);
+    stmt->execute();
+
+    // binary protocol
+    stmt = m_con->create_statement("SELECT tim, tiim FROM " + m_table_name + " WHERE id = 1;");
+    mariadb::result_set_ref rs = stmt->query();
+    ASSERT_TRUE(rs->next());
+    EXPECT_TRUE(rs->get_time_point(0) == tp);
+    EXPECT_EQ(du.count(), rs->get_duration(1).count());
+    EXPECT_EQ(mariadb::date_time(tp), rs->get_date_time(0));
+
+    // text protocol
+    rs = m_con->query("SELECT tim, tiim FROM " + m_table_name + " WHERE id = 1;");
+    ASSERT_TRUE(rs->next());
+    EXPECT_TRUE(rs->get_time_point(0) == tp);
+    EXPECT_EQ(du.count(), rs->get_duration(1).count());
+    EXPECT_EQ(mariadb::date_time(tp).microsecond(), rs->get_date_time(0).microsecond());
+}
+
 TEST_P(ParameterizedQueryTest, bindExecute) {
     mariadb::statement_ref crashQuery =
         m_con->create_statement("INSERT INTO " + m_table_name + " (id, preis) VALUES (2, ?);");
@@ -204,4 +231,59 @@ TEST_P(ParameterizedQueryTest, bindReuseString) {
     EXPECT_EQ("", result3->get_string(0));
 }
 
+TEST_P(ParameterizedQueryTest, bindData) {
+    char external[] = "external buffer";
+    mariadb::arena memory;
+
+    mariadb::data_ref wrapped = mariadb::data<char>::wrap(external, 8);
+    EXPECT_EQ(external, wrapped->get());
+
+    // short, moved and arena backed values
+    mariadb::data<char> small("short", 5);
+    mariadb::data<char> moved(std::move(small));
+    EXPECT_EQ(0u, small.size());
+    mariadb::data<char> long_value(std::string(100, 'x').c_str(), 100, memory);
+    EXPECT_EQ(100u, long_value.size());
+
+    // arena buffers are aligned for their type
+    mariadb::data<mariadb::u64> numbers(64, memory);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(numbers.get()) % alignof(mariadb::u64));
+
+    // copies own heap memory and outlive the arena of the original
+    std::unique_ptr<mariadb::data<char> > copy;
+    {
+        mariadb::arena scoped;
+        mariadb::data<char> arena_value(std::string(100, 'y').c_str(), 100, scoped);
+        copy.reset(new mariadb::data<char>(arena_value));
+    }
+    EXPECT_EQ(std::string(100, 'y'), copy->string());
+
+    mariadb::statement_ref insert =
+        m_con->create_statement("INSERT INTO " + m_table_name + " (id, str) VALUES (?, ?);");
+    const std::pair<int, mariadb::data_ref> values[] = {
+        {2, wrapped},
+        {3, std::make_shared<mariadb::data<char> >(moved)},
+        {4, std::make_shared<mariadb::data<char> >(long_value.get(), 30)}};
+
+    for (const auto &value : values) {
+        insert->set_signed32(0, value.first);
+        insert->set_data(1, value.second);
+        EXPECT_EQ(1u, insert->execute());
+    }
+
+    mariadb::result_set_ref queryResult =
+        m_con->query("SELECT str FROM " + m_table_name + " WHERE id > 1 ORDER BY id;");
+    ASSERT_TRUE(queryResult->next());
+    EXPECT_EQ("external", queryResult->get_string(0));
+    ASSERT_TRUE(queryResult->next());
+    EXPECT_EQ("short", queryResult->get_data(0)->string());
+    ASSERT_TRUE(queryResult->next());
+    EXPECT_EQ(std::string(30, 'x'), queryResult->get_string(0));
+
+    // growing wrapped memory copies it
+    ASSERT_TRUE(wrapped->resize(64));
+    EXPECT_NE(external, wrapped->get());
+    EXPECT_EQ("external", std::string(wrapped->get(), 8));
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, ParameterizedQueryTest, ::testing::Values(true, false));
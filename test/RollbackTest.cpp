@@ -123,4 +123,97 @@ TEST_P(RollbackTest, testMultiInsertIntegration) {
     EXPECT_EQ("11:22:33", rs->get_time("t").str_time());
 }
 
+TEST_P(RollbackTest, testRunInTransaction) {
+    // raises the error a deadlocked statement gets from the server
+    const std::string deadlock =
+        "BEGIN NOT ATOMIC SIGNAL SQLSTATE '40001' SET MYSQL_ERRNO = 1213, MESSAGE_TEXT = 'Deadlock'; END";
+
+    retry_policy policy;
+    policy.base_delay_ms = 1;
+
+    u32 calls = 0;
+    u32 attempts = m_con->run_in_transaction(
+        [&](transaction &) {
+            m_con->insert("INSERT INTO " + m_table_name + "(str) VALUES('retry');");
+            if (++calls == 1) m_con->execute(deadlock);
+        },
+        policy);
+
+    EXPECT_EQ(2u, attempts);
+    EXPECT_EQ(2u, calls);
+
+    // the insert of the aborted attempt is rolled back
+    result_set_ref rs = m_con->query("SELECT COUNT(*) FROM " + m_table_name + ";");
+    EXPECT_TRUE(rs->next());
+    EXPECT_EQ(1, rs->get_unsigned64(0));
+
+    // attempts are limited
+    calls = 0;
+    policy.max_attempts = 3;
+    EXPECT_THROW(m_con->run_in_transaction(
+                     [&](transaction &) {
+                         calls++;
+                         m_con->execute(deadlock);
+                     },
+                     policy),
+                 exception::connection);
+    EXPECT_EQ(3u, calls);
+
+    // other errors are not retried
+    calls = 0;
+    EXPECT_THROW(m_con->run_in_transaction(
+                     [&](transaction &) {
+                         calls++;
+                         m_con->execute("SELEKT 1;");
+                     },
+                     policy),
+                 exception::connection);
+    EXPECT_EQ(1u, calls);
+}
+
+TEST_P(RollbackTest, testTransactionStart) {
+    // a read only transaction rejects changes
+    {
+        transaction_ref trx = m_con->create_transaction(isolation::repeatable_read, true, true);
+        EXPECT_THROW(m_con->insert("INSERT INTO " + m_table_name + "(str) VALUES('test');"), exception::connection);
+    }
+
+    result_set_ref rs = m_con->query("SELECT @@SESSION.tx_isolation;");
+    ASSERT_TRUE(rs->next());
+    const std::string session_level = rs->get_string(0);
+
+    // the isolation level only applies to the transaction, also when a level is requested again
+    for (int i = 0; i < 2; i++) {
+        transaction_ref trx = m_con->create_transaction(isolation::read_uncommitted, false);
+        m_con->insert("INSERT INTO " + m_table_name + "(str) VALUES('test');");
+        trx->commit();
+    }
+
+    rs = m_con->query("SELECT @@SESSION.tx_isolation, COUNT(*) FROM " + m_table_name + ";");
+    EXPECT_TRUE(rs->next());
+    EXPECT_EQ(session_level, rs->get_string(0));
+    EXPECT_EQ(2, rs->get_unsigned64(1));
+}
+
+TEST_P(RollbackTest, testSessionAfterReconnect) {
+    // the client library reconnects on its own, connect() notices the new session and sets it up again
+    account_ref acc = account::create(m_account_setup->host_name(), m_account_setup->user_name(),
+                                      m_account_setup->password(), m_account_setup->schema(),
+                                      m_account_setup->port(), m_account_setup->unix_socket());
+    acc->set_connect_option(MYSQL_OPT_RECONNECT, true);
+    acc->set_auto_commit(false);
+
+    connection_ref con = connection::create(acc);
+    ASSERT_TRUE(con->connect());
+    const u64 id = con->thread_id();
+
+    m_con->execute("KILL " + std::to_string(id) + ";");
+
+    result_set_ref rs = con->query("SELECT @@autocommit, DATABASE();");
+    EXPECT_NE(id, con->thread_id());
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(0, rs->get_signed64(0));
+    EXPECT_EQ(m_account_setup->schema(), rs->get_string(1));
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, RollbackTest, ::testing::Values(true, false));
@@ -123,4 +123,62 @@ TEST_P(SelectTest, RealLimits) {
     EXPECT_FLOAT_EQ(0, res->get_double(4));
 }
 
+TEST_P(SelectTest, Materialize) {
+    m_con->execute("CREATE TABLE " + m_table_name +
+                   " (id INT, str VARCHAR(50) NULL, val DOUBLE NULL, PRIMARY KEY (`id`));");
+    m_con->execute("INSERT INTO " + m_table_name +
+                   " VALUES (1, 'one', 1.5), (2, NULL, NULL), (3, 'three', -3.25);");
+
+    statement_ref stmt =
+        m_con->create_statement("SELECT id, str, val FROM " + m_table_name + " WHERE id >= ? ORDER BY id;");
+    stmt->set_signed32(0, 1);
+
+    result_set_ref res = stmt->query();
+    ASSERT_TRUE(res->next());
+    EXPECT_EQ(1, res->get_signed32(0));
+    EXPECT_FALSE(res->is_detached());
+
+    // copy starts with the current row
+    result_set_ref detached = res->materialize();
+    EXPECT_TRUE(detached->is_detached());
+    EXPECT_EQ(3u, detached->row_count());
+
+    // the statement and connection can be reused while the copy is alive
+    stmt->set_signed32(0, 3);
+    result_set_ref other = stmt->query();
+    ASSERT_TRUE(other->next());
+    EXPECT_EQ(3, other->get_signed32("id"));
+    EXPECT_EQ(1u, m_con->execute("DELETE FROM " + m_table_name + " WHERE id = 1;"));
+
+    ASSERT_TRUE(detached->next());
+    EXPECT_EQ(1, detached->get_signed32("id"));
+    EXPECT_EQ("one", detached->get_string("str"));
+    EXPECT_DOUBLE_EQ(1.5, detached->get_double("val"));
+
+    ASSERT_TRUE(detached->next());
+    EXPECT_TRUE(detached->get_is_null("str"));
+    EXPECT_TRUE(detached->get_is_null("val"));
+
+    ASSERT_TRUE(detached->next());
+    EXPECT_EQ("three", detached->get_string(1));
+    EXPECT_FALSE(detached->next());
+
+    // rows can be revisited
+    ASSERT_TRUE(detached->set_row_index(1));
+    EXPECT_EQ(2, detached->get_signed32(0));
+
+    // unread detached results share their rows with every copy
+    result_set_ref text = m_con->query("SELECT str FROM " + m_table_name + " ORDER BY id;")->materialize();
+    result_set_ref first = text->materialize();
+    result_set_ref second = text->materialize();
+
+    ASSERT_TRUE(first->next());
+    ASSERT_TRUE(second->next());
+    EXPECT_TRUE(first->get_is_null(0));
+    EXPECT_TRUE(second->get_is_null(0));
+    ASSERT_TRUE(text->next());
+    ASSERT_TRUE(text->next());
+    EXPECT_EQ("three", text->get_string(0));
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, SelectTest, ::testing::Values(true, false));
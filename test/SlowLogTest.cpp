@@ -0,0 +1,67 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <sstream>
+#include <mariadb++/tracing.hpp>
+
+#include "SlowLogTest.h"
+
+TEST_P(SlowLogTest, testAggregate) {
+    slow_log::enable(0);
+
+    for (int i = 0; i < 3; i++) m_con->insert("INSERT INTO " + m_table_name + " (str) VALUES ('" + std::to_string(i) + "');");
+
+    statement_ref stmt = m_con->create_statement("SELECT str FROM " + m_table_name + " WHERE id > ?;");
+    stmt->set_unsigned32(0, 1);
+    stmt->query();
+
+    EXPECT_ANY_THROW(m_con->execute("DELETE FROM " + m_table_name + " WHERE nope = 1;"));
+
+    const std::vector<slow_log::entry> top = slow_log::get_top();
+    ASSERT_EQ(3u, top.size());
+
+    for (const slow_log::entry &e : top) {
+        EXPECT_EQ(tracing::fingerprint(e.sql), e.fingerprint);
+
+        if (e.sql == "INSERT INTO " + m_table_name + " (str) VALUES (?)") {
+            EXPECT_EQ(3u, e.count);
+            EXPECT_EQ(3u, e.rows);
+            EXPECT_LE(e.max_time, e.total_time);
+        } else if (e.sql == "DELETE FROM " + m_table_name + " WHERE nope = ?") {
+            EXPECT_EQ(1u, e.errors);
+        } else {
+            EXPECT_EQ("SELECT str FROM " + m_table_name + " WHERE id > ?", e.sql);
+            // only buffered results know their rows when the call ends
+            EXPECT_EQ(GetParam() ? 2u : 0u, e.rows);
+        }
+    }
+
+    for (size_t i = 1; i < top.size(); i++) EXPECT_GE(top[i - 1].total_time, top[i].total_time);
+}
+
+TEST_P(SlowLogTest, testThresholdAndCapacity) {
+    slow_log::enable(100, 1);
+
+    m_con->execute("DO 1;");
+    EXPECT_TRUE(slow_log::get_top().empty());
+
+    m_con->execute("DO SLEEP(0.15);");
+    m_con->execute("DO SLEEP(0.3), 1;");
+
+    // the longer query replaced the shorter one
+    const std::vector<slow_log::entry> top = slow_log::get_top();
+    ASSERT_EQ(1u, top.size());
+    EXPECT_EQ("DO SLEEP(?), ?", top[0].sql);
+    EXPECT_LE(300000000u, top[0].total_time);
+
+    std::ostringstream os;
+    slow_log::dump(os);
+    EXPECT_NE(std::string::npos, os.str().find(" DO SLEEP(?), ?\n"));
+}
+
+INSTANTIATE_TEST_SUITE_P(BufUnbuf, SlowLogTest, ::testing::Values(true, false));
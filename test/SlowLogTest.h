@@ -0,0 +1,32 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_SLOWLOGTEST_H
+#define MARIADBCLIENTPP_SLOWLOGTEST_H
+
+#include <mariadb++/slow_log.hpp>
+#include "SkeletonTest.h"
+
+class SlowLogTest : public SkeletonTest {
+   protected:
+    virtual void SetUp() override {
+        SkeletonTest::SetUp();
+        slow_log::reset();
+    }
+
+    virtual void TearDown() override {
+        slow_log::disable();
+        SkeletonTest::TearDown();
+    }
+
+    virtual void CreateTestTable() override {
+        m_con->execute("CREATE TABLE " + m_table_name + " (id INT AUTO_INCREMENT, str VARCHAR(50), PRIMARY KEY(id));");
+    }
+};
+
+#endif  // MARIADBCLIENTPP_SLOWLOGTEST_H
@@ -55,4 +55,50 @@ TEST_P(StructureTest, testDecimal) {
     EXPECT_EQ("24.1234", d.str());
 }
 
+TEST_P(StructureTest, testDecimalArithmetic) {
+    decimal price("19.99"), rate("0.075");
+
+    EXPECT_TRUE(price.is_exact());
+    EXPECT_EQ(1999, price.unscaled());
+    EXPECT_EQ(2, price.scale());
+
+    decimal total("0.00");
+    for (int i = 0; i < 1000; i++) total += price;
+    EXPECT_EQ("19990.00", total.str());
+
+    EXPECT_EQ("1.49925", (price * rate).str());
+    EXPECT_EQ("1.50", (price * rate).rescale(2).str());
+    EXPECT_EQ("-0.01", (price - decimal("20")).str());
+
+    EXPECT_EQ(decimal("19.990"), price);
+    EXPECT_LT(decimal("-1"), rate);
+    EXPECT_GT(price, rate);
+
+    // too long for exact representation, still round trips as text
+    decimal huge("12345678901234567890123.45");
+    EXPECT_FALSE(huge.is_exact());
+    EXPECT_EQ("12345678901234567890123.45", huge.str());
+    EXPECT_THROW(huge + price, std::domain_error);
+}
+
+TEST_P(StructureTest, testDecimalZero) {
+    decimal zero;
+    EXPECT_TRUE(zero.is_exact());
+    EXPECT_EQ("0", zero.str());
+    EXPECT_EQ(decimal("0"), zero);
+    EXPECT_EQ(decimal("0.00"), decimal(""));
+
+    zero += decimal("1.25");
+    EXPECT_EQ("1.25", zero.str());
+
+    // NULL columns read as zero
+    m_con->execute("CREATE TABLE " + m_table_name + " (deci DECIMAL(8,2) NULL);");
+    m_con->execute("INSERT INTO " + m_table_name + " VALUES (NULL);");
+
+    result_set_ref rs = m_con->query("SELECT deci FROM " + m_table_name + ";");
+    ASSERT_TRUE(rs->next());
+    EXPECT_EQ(decimal(), rs->get_decimal(0));
+    EXPECT_EQ(decimal("1.25"), rs->get_decimal(0) + decimal("1.25"));
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, StructureTest, ::testing::Values(true, false));
@@ -57,7 +57,6 @@ TEST_P(TimeTest, testConstructors) {
     EXPECT_ANY_THROW(mariadb::time d("23:59:62"));
     EXPECT_ANY_THROW(mariadb::time d("23:59:a59.1000"));
     EXPECT_ANY_THROW(mariadb::time m("859"));
-    EXPECT_INVALID(mariadb::time, "23:59:59.1000");
 
     EXPECT_NE(a, b);
     EXPECT_EQ(b, c);
@@ -71,7 +70,7 @@ TEST_P(TimeTest, testConstructors) {
     EXPECT_EQ("23:59:59.999", h.str_time(true));
     EXPECT_EQ("13:37:42.000", i.str_time(true));
     EXPECT_EQ("18:59:59.000", j.str_time(true));
-    EXPECT_EQ("08:09:05.001", k.str_time(true));
+    EXPECT_EQ("08:09:05.010", k.str_time(true));
     EXPECT_EQ("08:59:59", l.str_time());
 }
 
@@ -296,4 +295,76 @@ TEST_P(TimeTest, testDateTime) {
     EXPECT_EQ("2008-02-29", ba.str_date());
 }
 
+TEST_P(TimeTest, testCivilDays) {
+    EXPECT_EQ(0, date_time::days_from_civil(1970, 1, 1));
+    EXPECT_EQ(11017, date_time::days_from_civil(2000, 3, 1));
+    EXPECT_EQ(-719162, date_time::days_from_civil(1, 1, 1));
+
+    for (s64 days = -719162; days < 2932897; days += 97) {
+        date_time dt = date_time::civil_from_days(days);
+        EXPECT_EQ(days, date_time::days_from_civil(dt.year(), dt.month(), dt.day()));
+    }
+
+    // month and day arithmetic spanning many years
+    date_time dt(2000, 1, 31, 23, 59, 59, 999);
+    EXPECT_EQ(date_time(2100, 3, 1, 23, 59, 59, 999), dt.add_days(36554));
+    EXPECT_EQ(date_time(1900, 1, 1, 23, 59, 59, 999), dt.add_months(-1200).add_days(-30));
+    EXPECT_EQ(date_time(2000, 2, 1, 0, 0, 0, 0), dt.add_milliseconds(1));
+    EXPECT_EQ(date_time(1999, 12, 31, 23, 59, 59, 999), dt.add_hours(-24 * 31));
+    EXPECT_DOUBLE_EQ(0.001, date_time(2000, 2, 1).diff_time(dt));
+}
+
+TEST_P(TimeTest, testMicroseconds) {
+    using namespace std::chrono;
+
+    date_time a("2024-02-29 23:59:59.999999");
+    EXPECT_EQ(999999u, a.microsecond());
+    EXPECT_EQ(999, a.millisecond());
+    EXPECT_EQ("2024-03-01 00:00:00", a.add(microseconds(1)).str());
+    EXPECT_LT(a, a.add(microseconds(1)));
+    EXPECT_EQ(999999u, date_time(a.mysql_time()).microsecond());
+
+    // system clock round trip, including points before the epoch
+    EXPECT_EQ(a, date_time(a.time_point()));
+    date_time b(system_clock::time_point(duration_cast<system_clock::duration>(microseconds(-1))));
+    EXPECT_EQ("1969-12-31 23:59:59.999", b.str(true));
+    EXPECT_EQ(999999u, b.microsecond());
+
+    mariadb::time t(microseconds(-1));
+    EXPECT_EQ("23:59:59.999", t.str_time(true));
+    EXPECT_EQ(microseconds(hours(24) - microseconds(1)), t.time_of_day());
+    EXPECT_EQ(1u, t.add(microseconds(2)).microsecond());
+    EXPECT_EQ(1000u, mariadb::time("00:00:00.001").microsecond());
+    EXPECT_EQ(1u, mariadb::time("00:00:00.000001").microsecond());
+
+    // fractions of TIME(1) to TIME(5) are scaled by their number of digits
+    EXPECT_EQ(500000u, mariadb::time("00:00:00.5").microsecond());
+    EXPECT_EQ(123400u, mariadb::time("00:00:00.1234").microsecond());
+    EXPECT_EQ(100, mariadb::time("23:59:59.1000").millisecond());
+    EXPECT_EQ(123456u, date_time("2024-02-29 23:59:59.1234567").microsecond());
+}
+
+TEST_P(TimeTest, testUtc) {
+    EXPECT_EQ(date_time(1970, 1, 1), date_time(static_cast<time_t>(0)));
+    EXPECT_EQ(date_time(2038, 1, 19, 3, 14, 7), date_time(static_cast<time_t>(2147483647)));
+    EXPECT_EQ(date_time(1969, 12, 31, 23, 59, 59), date_time(static_cast<time_t>(-1)));
+    EXPECT_EQ(mariadb::time(23, 59, 59), mariadb::time(static_cast<time_t>(-1)));
+
+    for (s64 t = -2000000000; t < 2000000000; t += 99999989)
+        EXPECT_EQ(static_cast<time_t>(t), date_time(static_cast<time_t>(t)).mktime());
+
+    EXPECT_EQ(static_cast<time_t>(4 * 3600 + 5 * 60 + 6), mariadb::time(4, 5, 6).mktime());
+
+    // the realtime clock and the system clock agree on UTC
+    const date_time before(std::chrono::system_clock::now());
+    const date_time now = date_time::now_utc();
+    const date_time after(std::chrono::system_clock::now());
+    EXPECT_LE(before, now);
+    EXPECT_LE(now, after);
+
+    // local time is only used when asked for
+    const time_t t = ::time(nullptr);
+    EXPECT_EQ(t, date_time::from_local_time(t).mktime_local());
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, TimeTest, ::testing::Values(true, false));
@@ -0,0 +1,80 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <mariadb++/connection_pool.hpp>
+
+#include "TracingTest.h"
+
+TEST_P(TracingTest, testCallbacks) {
+    m_con->insert("INSERT INTO " + m_table_name + " (str) VALUES ('a'), ('b');");
+
+    result_set_ref rs = m_con->query("SELECT str FROM " + m_table_name + " WHERE id < 10;");
+    while (rs->next()) {
+    }
+
+    statement_ref stmt = m_con->create_statement("UPDATE " + m_table_name + " SET str = ? WHERE id = 1;");
+    stmt->set_string(0, "c");
+    EXPECT_EQ(1u, stmt->execute());
+
+    const std::string table = m_table_name;
+    const std::vector<std::string> expected = {
+        "query_start: INSERT INTO " + table + " (str) VALUES (?)",
+        "query_end: INSERT INTO " + table + " (str) VALUES (?)",
+        "query_start: SELECT str FROM " + table + " WHERE id < ?",
+        "query_end: SELECT str FROM " + table + " WHERE id < ?",
+        "fetch: ",
+        "fetch: ",
+        "fetch: ",
+        "prepare: UPDATE " + table + " SET str = ? WHERE id = ?",
+        "execute: UPDATE " + table + " SET str = ? WHERE id = ?"};
+    EXPECT_EQ(expected, m_observer.Calls());
+
+    const std::vector<tracing::span> spans = m_observer.Spans();
+    ASSERT_EQ(expected.size(), spans.size());
+    EXPECT_EQ(2u, spans[1].rows);
+    EXPECT_EQ(1u, spans[4].rows);
+    EXPECT_EQ(0u, spans[6].rows);
+    EXPECT_EQ(1u, spans[8].rows);
+    EXPECT_LE(spans[0].start, spans[2].start);
+}
+
+TEST_P(TracingTest, testConnectAndPool) {
+    connection_pool_ref pool = connection_pool::create(m_account_setup);
+    {
+        connection_ref conn = pool->acquire();
+        conn->connect();
+    }
+
+    tracing::remove_observer(&m_observer);
+    m_con->execute("DO 1;");
+
+    const std::vector<std::string> expected = {"pool_wait: ", "connect: "};
+    EXPECT_EQ(expected, m_observer.Calls());
+}
+
+TEST_P(TracingTest, testFailure) {
+    EXPECT_ANY_THROW(m_con->query("SELECT nope FROM " + m_table_name + ";"));
+
+    const std::vector<tracing::span> spans = m_observer.Spans();
+    ASSERT_EQ(2u, spans.size());
+    EXPECT_EQ(0u, spans[0].error);
+    EXPECT_EQ(1054u, spans[1].error);
+}
+
+TEST_P(TracingTest, testNormalize) {
+    EXPECT_EQ("SELECT * FROM t1 WHERE id = ? AND name = ?",
+              tracing::normalize("SELECT *  FROM t1\n WHERE id = 42 AND name = 'o''brien' -- comment\n;"));
+    EXPECT_EQ("SELECT a FROM `t 2` WHERE x IN (?) AND y = -?",
+              tracing::normalize("SELECT a FROM `t 2` /* hint */ WHERE x IN (1, 2,3) AND y = -1.5e3"));
+    EXPECT_EQ("INSERT INTO t VALUES (?),(?)", tracing::normalize("INSERT INTO t VALUES (1, \"a\"),(0x1F, x'AB');"));
+
+    EXPECT_EQ(tracing::fingerprint("SELECT 1 FROM t WHERE id = 5"), tracing::fingerprint("SELECT 2 FROM t WHERE id = 7"));
+    EXPECT_NE(tracing::fingerprint("SELECT 1 FROM t WHERE id = 5"), tracing::fingerprint("SELECT 1 FROM u WHERE id = 5"));
+}
+
+INSTANTIATE_TEST_SUITE_P(BufUnbuf, TracingTest, ::testing::Values(true, false));
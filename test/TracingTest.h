@@ -0,0 +1,74 @@
+//
+//  M A R I A D B + +
+//
+//          Copyright The ViaDuck Project 2016 - 2024.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MARIADBCLIENTPP_TRACINGTEST_H
+#define MARIADBCLIENTPP_TRACINGTEST_H
+
+#include <mutex>
+#include <vector>
+#include <mariadb++/tracing.hpp>
+#include "SkeletonTest.h"
+
+//
+// Records the callbacks it receives as "name: normalized SQL"
+//
+class RecordingObserver : public tracing::observer {
+   public:
+    virtual void on_query_start(const tracing::span &s) override { Record("query_start", s); }
+    virtual void on_query_end(const tracing::span &s) override { Record("query_end", s); }
+    virtual void on_prepare(const tracing::span &s) override { Record("prepare", s); }
+    virtual void on_execute(const tracing::span &s) override { Record("execute", s); }
+    virtual void on_fetch_batch(const tracing::span &s) override { Record("fetch", s); }
+    virtual void on_connect(const tracing::span &s) override { Record("connect", s); }
+    virtual void on_pool_wait(const tracing::span &s) override { Record("pool_wait", s); }
+
+    std::vector<std::string> Calls() {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_calls;
+    }
+
+    std::vector<tracing::span> Spans() {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_spans;
+    }
+
+   private:
+    void Record(const char *name, const tracing::span &s) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_calls.push_back(std::string(name) + ": " + s.normalized());
+
+        // the SQL text is only valid during the callback
+        m_spans.push_back(s);
+        m_spans.back().sql = nullptr;
+    }
+
+    std::mutex m_lock;
+    std::vector<std::string> m_calls;
+    std::vector<tracing::span> m_spans;
+};
+
+class TracingTest : public SkeletonTest {
+   protected:
+    virtual void SetUp() override {
+        SkeletonTest::SetUp();
+        tracing::add_observer(&m_observer);
+    }
+
+    virtual void TearDown() override {
+        tracing::remove_observer(&m_observer);
+        SkeletonTest::TearDown();
+    }
+
+    virtual void CreateTestTable() override {
+        m_con->execute("CREATE TABLE " + m_table_name + " (id INT AUTO_INCREMENT, str VARCHAR(50), PRIMARY KEY(id));");
+    }
+
+    RecordingObserver m_observer;
+};
+
+#endif  // MARIADBCLIENTPP_TRACINGTEST_H
@@ -6,6 +6,9 @@
 //    (See accompanying file LICENSE or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <sstream>
+#include <iterator>
+
 #include "TruncationTest.h"
 
 TEST_P(TruncationTest, testUInt) {
@@ -31,4 +34,113 @@ TEST_P(TruncationTest, testUInt) {
     ASSERT_EQ(max, stmt_res->get_unsigned32(0));
 }
 
+TEST_P(TruncationTest, testGrowingStrings) {
+    m_con->execute("ALTER TABLE " + m_table_name + " ADD COLUMN str TEXT, ADD COLUMN pad VARCHAR(10);");
+
+    // every row is longer than all before, so unbuffered results have to grow their buffers
+    std::vector<std::string> values;
+    for (uint32_t i = 0; i < 8; i++) {
+        values.emplace_back(std::string(1u << (2 * i), static_cast<char>('a' + i)));
+        m_con->execute("INSERT INTO " + m_table_name + " VALUES (" + std::to_string(i) + ", '" + values.back() +
+                       "', 'x');");
+    }
+
+    statement_ref stmt = m_con->create_statement("SELECT id, str, pad FROM " + m_table_name + " ORDER BY id;");
+    result_set_ref res = stmt->query();
+    ASSERT_TRUE(!!res);
+
+    for (const std::string &value : values) {
+        ASSERT_TRUE(res->next());
+        EXPECT_EQ(value.size(), res->column_size(1));
+        EXPECT_EQ(value, res->get_string(1));
+        EXPECT_EQ("x", res->get_string(2));
+    }
+
+    EXPECT_FALSE(res->next());
+}
+
+TEST_P(TruncationTest, testStreamedBlob) {
+    m_con->execute("ALTER TABLE " + m_table_name + " ADD COLUMN content LONGBLOB;");
+    m_account_setup->set_stream_threshold(1024);
+
+    std::string content(300 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); i++) content[i] = static_cast<char>(i * 7 % 251);
+
+    statement_ref insert = m_con->create_statement("INSERT INTO " + m_table_name + " VALUES (?, ?);");
+    insert->set_unsigned32(0, 1);
+    insert->set_blob(1, stream_ref(new std::istringstream(content)));
+    insert->execute();
+    insert->set_unsigned32(0, 2);
+    insert->set_blob(1, stream_ref(new std::istringstream("small")));
+    insert->execute();
+
+    statement_ref stmt = m_con->create_statement("SELECT id, content FROM " + m_table_name + " ORDER BY id;");
+    result_set_ref res = stmt->query();
+    ASSERT_TRUE(res->next());
+    EXPECT_EQ(content.size(), res->column_size(1));
+
+    // streamed in chunks
+    stream_ref blob = res->get_blob(1);
+    ASSERT_TRUE(!!blob);
+    std::string streamed((std::istreambuf_iterator<char>(*blob)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, streamed);
+
+    // seeking back fetches the chunk again
+    blob->clear();
+    blob->seekg(100);
+    char c = 0;
+    blob->read(&c, 1);
+    EXPECT_EQ(content[100], c);
+
+    // all other getters read the complete value on demand
+    EXPECT_EQ(content, res->get_string(1));
+    EXPECT_EQ(content.size(), res->get_data(1)->size());
+
+    ASSERT_TRUE(res->next());
+    blob = res->get_blob(1);
+    ASSERT_TRUE(!!blob);
+    std::string small;
+    *blob >> small;
+    EXPECT_EQ("small", small);
+}
+
+TEST_P(TruncationTest, testStreamedBlobAfterLoad) {
+    m_con->execute("ALTER TABLE " + m_table_name + " ADD COLUMN content LONGBLOB;");
+    m_account_setup->set_stream_threshold(100 * 1024);
+
+    const std::string big(300 * 1024, 'a');
+    const std::string big_again(200 * 1024, 'b');
+
+    statement_ref insert = m_con->create_statement("INSERT INTO " + m_table_name + " VALUES (?, ?);");
+    insert->set_unsigned32(0, 1);
+    insert->set_blob(1, stream_ref(new std::istringstream(big)));
+    insert->execute();
+    insert->set_unsigned32(0, 2);
+    insert->set_blob(1, stream_ref(new std::istringstream("small")));
+    insert->execute();
+    insert->set_unsigned32(0, 3);
+    insert->set_blob(1, stream_ref(new std::istringstream(big_again)));
+    insert->execute();
+
+    statement_ref stmt = m_con->create_statement("SELECT id, content FROM " + m_table_name + " ORDER BY id;");
+    result_set_ref res = stmt->query();
+
+    // loading the first value grows the buffer beyond the size of the third
+    ASSERT_TRUE(res->next());
+    EXPECT_EQ(big, res->get_string(1));
+
+    ASSERT_TRUE(res->next());
+    EXPECT_EQ("small", res->get_string(1));
+
+    // the third value is still read, not the bytes left from the first
+    ASSERT_TRUE(res->next());
+    EXPECT_EQ(big_again.size(), res->column_size(1));
+    stream_ref blob = res->get_blob(1);
+    ASSERT_TRUE(!!blob);
+    EXPECT_EQ(big_again, std::string((std::istreambuf_iterator<char>(*blob)), std::istreambuf_iterator<char>()));
+    EXPECT_EQ(big_again, res->get_string(1));
+
+    EXPECT_FALSE(res->next());
+}
+
 INSTANTIATE_TEST_SUITE_P(BufUnbuf, TruncationTest, ::testing::Values(true, false));